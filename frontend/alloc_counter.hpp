@@ -0,0 +1,9 @@
+#pragma once
+
+#include <cstddef>
+
+// Test hook for the zero-allocation frame budget. Building with
+// -DAPPLE_GAME_COUNT_ALLOCS replaces the global operator new so every heap
+// allocation in the process is counted; otherwise the counter stays at zero.
+bool allocationCountingEnabled();
+std::size_t allocationCount();
@@ -0,0 +1,64 @@
+#include "apple_batch.hpp"
+
+#include <cmath>
+
+AppleBatch::AppleBatch(unsigned segments)
+    : vertices(sf::PrimitiveType::Triangles), used(0) {
+    const float step = 2.f * 3.14159265f / static_cast<float>(segments);
+    for (unsigned i = 0; i < segments; ++i) {
+        float angle = step * static_cast<float>(i);
+        unitCircle.push_back(sf::Vector2f(std::cos(angle), std::sin(angle)));
+    }
+}
+
+void AppleBatch::addCircle(sf::Vector2f topLeft, float radius, sf::Color color) {
+    const std::size_t segments = unitCircle.size();
+    const std::size_t needed = used + segments * 3;
+    if (vertices.getVertexCount() < needed) {
+        vertices.resize(needed * 2);
+    }
+
+    const sf::Vector2f center(topLeft.x + radius, topLeft.y + radius);
+    for (std::size_t i = 0; i < segments; ++i) {
+        const sf::Vector2f& from = unitCircle[i];
+        const sf::Vector2f& to = unitCircle[(i + 1) % segments];
+
+        sf::Vertex* triangle = &vertices[used];
+        triangle[0].position = center;
+        triangle[1].position = sf::Vector2f(center.x + from.x * radius, center.y + from.y * radius);
+        triangle[2].position = sf::Vector2f(center.x + to.x * radius, center.y + to.y * radius);
+        triangle[0].color = color;
+        triangle[1].color = color;
+        triangle[2].color = color;
+        used += 3;
+    }
+}
+
+void AppleBatch::addApples(const AppleField& apples, std::uint8_t alpha, float speedLag) {
+    for (std::size_t i = 0; i < apples.size(); ++i) {
+        sf::Color color = appleColor(apples.type[i]);
+        color.a = alpha;
+        float lag = apples.active[i] ? apples.speed[i] * speedLag : 0.f;
+        addCircle(sf::Vector2f(apples.x[i], apples.y[i] - lag), APPLE_RADIUS, color);
+    }
+}
+
+unsigned AppleBatch::draw(sf::RenderTarget& target) const {
+    if (used == 0) {
+        return 0;
+    }
+    target.draw(&vertices[0], used, sf::PrimitiveType::Triangles);
+    return 1;
+}
+
+sf::Color appleColor(AppleType type) {
+    switch(type) {
+        case AppleType::RED:
+            return sf::Color(220, 20, 60);
+        case AppleType::GOLDEN:
+            return sf::Color(255, 215, 0);
+        case AppleType::ROTTEN:
+            return sf::Color(101, 67, 33);
+    }
+    return sf::Color::White;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "../src/apple_field.hpp"
+
+// Collects filled circles into one reused triangle list so a whole field of
+// apples (plus glows and auras) goes out in a single draw call. The vertex
+// array only grows; clear() keeps its storage for the next frame.
+class AppleBatch {
+private:
+    sf::VertexArray vertices;
+    std::vector<sf::Vector2f> unitCircle;
+    std::size_t used;
+
+public:
+    explicit AppleBatch(unsigned segments = 24);
+
+    void clear() { used = 0; }
+
+    // Same placement as sf::CircleShape: topLeft is the corner of the bounding box
+    void addCircle(sf::Vector2f topLeft, float radius, sf::Color color);
+
+    // Every apple of the field, with the given alpha applied to its color.
+    // speedLag pulls each apple back by speed * speedLag along its fall, which
+    // places it between simulation ticks (see Game::render).
+    void addApples(const AppleField& apples, std::uint8_t alpha = 255, float speedLag = 0.f);
+
+    std::size_t circleCount() const { return used / (unitCircle.size() * 3); }
+
+    // Returns the number of draw calls issued (0 or 1)
+    unsigned draw(sf::RenderTarget& target) const;
+};
+
+sf::Color appleColor(AppleType type);
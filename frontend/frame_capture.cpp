@@ -0,0 +1,127 @@
+#include "frame_capture.hpp"
+
+#include <SFML/Window/Context.hpp>
+#include <cstring>
+
+namespace {
+
+#if defined(_WIN32)
+#define CAPTURE_GL_API __stdcall
+#else
+#define CAPTURE_GL_API
+#endif
+
+// Pixel buffer objects are OpenGL 2.1, past what SFML's headers declare, so
+// every entry point is looked up at run time; then the game needs no OpenGL
+// library of its own to link against
+const unsigned GL_RGBA_ID = 0x1908;
+const unsigned GL_UNSIGNED_BYTE_ID = 0x1401;
+const unsigned GL_PIXEL_PACK_BUFFER_ID = 0x88EB;
+const unsigned GL_STREAM_READ_ID = 0x88E1;
+const unsigned GL_READ_ONLY_ID = 0x88B8;
+
+using GenBuffersFn = void (CAPTURE_GL_API*)(int, unsigned*);
+using DeleteBuffersFn = void (CAPTURE_GL_API*)(int, const unsigned*);
+using BindBufferFn = void (CAPTURE_GL_API*)(unsigned, unsigned);
+using BufferDataFn = void (CAPTURE_GL_API*)(unsigned, std::ptrdiff_t, const void*, unsigned);
+using MapBufferFn = void* (CAPTURE_GL_API*)(unsigned, unsigned);
+using UnmapBufferFn = unsigned char (CAPTURE_GL_API*)(unsigned);
+using ReadPixelsFn = void (CAPTURE_GL_API*)(int, int, int, int, unsigned, unsigned, void*);
+
+struct BufferFunctions {
+    GenBuffersFn genBuffers;
+    DeleteBuffersFn deleteBuffers;
+    BindBufferFn bindBuffer;
+    BufferDataFn bufferData;
+    MapBufferFn mapBuffer;
+    UnmapBufferFn unmapBuffer;
+    ReadPixelsFn readPixels;
+
+    // Needs a current context
+    bool load() {
+        genBuffers = reinterpret_cast<GenBuffersFn>(sf::Context::getFunction("glGenBuffers"));
+        deleteBuffers = reinterpret_cast<DeleteBuffersFn>(sf::Context::getFunction("glDeleteBuffers"));
+        bindBuffer = reinterpret_cast<BindBufferFn>(sf::Context::getFunction("glBindBuffer"));
+        bufferData = reinterpret_cast<BufferDataFn>(sf::Context::getFunction("glBufferData"));
+        mapBuffer = reinterpret_cast<MapBufferFn>(sf::Context::getFunction("glMapBuffer"));
+        unmapBuffer = reinterpret_cast<UnmapBufferFn>(sf::Context::getFunction("glUnmapBuffer"));
+        readPixels = reinterpret_cast<ReadPixelsFn>(sf::Context::getFunction("glReadPixels"));
+        return genBuffers && deleteBuffers && bindBuffer && bufferData && mapBuffer && unmapBuffer && readPixels;
+    }
+};
+
+BufferFunctions gl;
+
+}
+
+FrameCapture::FrameCapture() : width(0), height(0), async(false), buffers{}, issued(0), collected(0) {}
+
+void FrameCapture::init(sf::RenderTexture& canvas) {
+    width = canvas.getSize().x;
+    height = canvas.getSize().y;
+    issued = 0;
+    collected = 0;
+    async = canvas.setActive(true) && gl.load();
+    if (!async) {
+        return;
+    }
+    gl.genBuffers(static_cast<int>(CAPTURE_DEPTH), buffers);
+    for (unsigned buffer : buffers) {
+        gl.bindBuffer(GL_PIXEL_PACK_BUFFER_ID, buffer);
+        gl.bufferData(GL_PIXEL_PACK_BUFFER_ID, static_cast<std::ptrdiff_t>(width) * height * 4, nullptr,
+                      GL_STREAM_READ_ID);
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER_ID, 0);
+}
+
+void FrameCapture::release(sf::RenderTexture& canvas) {
+    if (async && canvas.setActive(true)) {
+        gl.deleteBuffers(static_cast<int>(CAPTURE_DEPTH), buffers);
+    }
+    async = false;
+    issued = 0;
+    collected = 0;
+}
+
+void FrameCapture::read(sf::RenderTexture& canvas) {
+    const std::size_t slot = issued % CAPTURE_DEPTH;
+    issued++;
+    if (!async) {
+        images[slot] = canvas.getTexture().copyToImage();
+        return;
+    }
+    // With a pack buffer bound, glReadPixels only queues the copy
+    if (!canvas.setActive(true)) {
+        return;
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER_ID, buffers[slot]);
+    gl.readPixels(0, 0, static_cast<int>(width), static_cast<int>(height), GL_RGBA_ID, GL_UNSIGNED_BYTE_ID, nullptr);
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER_ID, 0);
+}
+
+void FrameCapture::collect(sf::RenderTexture& canvas, std::uint8_t* rgba) {
+    const std::size_t slot = collected % CAPTURE_DEPTH;
+    collected++;
+    const std::size_t rowSize = static_cast<std::size_t>(width) * 4;
+    if (!async) {
+        std::memcpy(rgba, images[slot].getPixelsPtr(), rowSize * height);
+        return;
+    }
+    if (!canvas.setActive(true)) {
+        return;
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER_ID, buffers[slot]);
+    const auto* pixels = static_cast<const std::uint8_t*>(gl.mapBuffer(GL_PIXEL_PACK_BUFFER_ID, GL_READ_ONLY_ID));
+    if (pixels) {
+        // OpenGL reads bottom row first
+        for (unsigned y = 0; y < height; ++y) {
+            std::memcpy(rgba + y * rowSize, pixels + (height - 1 - y) * rowSize, rowSize);
+        }
+        gl.unmapBuffer(GL_PIXEL_PACK_BUFFER_ID);
+    }
+    gl.bindBuffer(GL_PIXEL_PACK_BUFFER_ID, 0);
+}
+
+void FrameCapture::discard() {
+    collected++;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+#include <cstdint>
+
+// Reads in flight; a read is copied out CAPTURE_DEPTH - 1 frames after it was issued
+const std::size_t CAPTURE_DEPTH = 3;
+
+// Asynchronous readback of a RenderTexture. read() queues a copy of the
+// frame into one of CAPTURE_DEPTH OpenGL pixel buffer objects and returns at
+// once; the GPU fills the buffer while the next frames are built, and
+// collect() maps it a couple of frames later, when the transfer is long done,
+// so the game thread never waits on the GPU. Drivers without pixel buffer
+// objects fall back to a synchronous copyToImage().
+class FrameCapture {
+private:
+    unsigned width;
+    unsigned height;
+    bool async;
+    unsigned buffers[CAPTURE_DEPTH];
+    // Synchronous fallback: the frames themselves
+    sf::Image images[CAPTURE_DEPTH];
+    // Reads issued and reads collected or discarded so far
+    std::size_t issued;
+    std::size_t collected;
+
+public:
+    FrameCapture();
+
+    FrameCapture(const FrameCapture&) = delete;
+    FrameCapture& operator=(const FrameCapture&) = delete;
+
+    // Sets up the buffers in the canvas's context
+    void init(sf::RenderTexture& canvas);
+    // Frees them; needs the same canvas, since its context owns them
+    void release(sf::RenderTexture& canvas);
+
+    bool isAsync() const { return async; }
+    std::size_t pending() const { return issued - collected; }
+
+    // Queues a read of the canvas as it is after its last display()
+    void read(sf::RenderTexture& canvas);
+
+    // Copies the oldest read into rgba (width * height * 4 bytes, top row first)
+    void collect(sf::RenderTexture& canvas, std::uint8_t* rgba);
+    // Drops the oldest read unseen
+    void discard();
+};
@@ -0,0 +1,114 @@
+#include "frame_pacer.hpp"
+
+#include <SFML/System/Sleep.hpp>
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace {
+
+// Spin bounds, slack on top of the worst oversleep, and how much of the spin
+// and work estimates carries over per frame. Past MAX_SPIN_SECONDS a late
+// wake-up costs a late frame rather than a core spinning most of every frame.
+const double MIN_SPIN_SECONDS = 0.0002;
+const double MAX_SPIN_SECONDS = 0.004;
+const double START_SPIN_SECONDS = 0.002;
+const double SPIN_MARGIN_SECONDS = 0.00025;
+const double ESTIMATE_DECAY = 0.98;
+// Slack between the end of the work estimate and the deadline
+const double WORK_MARGIN_SECONDS = 0.0005;
+
+}
+
+FramePacer::FramePacer()
+    : mode(PacingMode::TARGET), targetHz(60), period(1.0 / 60), epoch(Clock::now()), deadline(0), wokeAt(0),
+      lastShown(0), work(0), spin(START_SPIN_SECONDS), intervals{}, errors{}, head(0), filled(0), late(0) {}
+
+double FramePacer::now() const {
+    return std::chrono::duration<double>(Clock::now() - epoch).count();
+}
+
+void FramePacer::setMode(PacingMode pacingMode, double hz) {
+    mode = pacingMode;
+    targetHz = std::max(1.0, hz);
+    period = 1.0 / targetHz;
+    deadline = 0;
+    lastShown = 0;
+    head = 0;
+    filled = 0;
+    late = 0;
+}
+
+void FramePacer::sleepUntil(double wake) {
+    double start = now();
+    if (wake - start > spin) {
+        const double asked = wake - spin;
+        // sf::sleep raises the Windows timer resolution for the call
+        sf::sleep(sf::microseconds(static_cast<std::int64_t>((asked - start) * 1.0e6)));
+        const double overslept = now() - asked;
+        spin = std::min(MAX_SPIN_SECONDS,
+                        std::max({MIN_SPIN_SECONDS, overslept + SPIN_MARGIN_SECONDS, spin * ESTIMATE_DECAY}));
+    }
+    while (now() < wake) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::wait() {
+    double start = now();
+    if (mode == PacingMode::TARGET) {
+        if (deadline < start - period) {
+            // Fell a whole frame behind; start over rather than rush to catch up
+            deadline = start + period;
+        }
+        const double wake = deadline - work - WORK_MARGIN_SECONDS;
+        if (wake > start) {
+            sleepUntil(wake);
+        }
+    }
+    wokeAt = now();
+}
+
+void FramePacer::shown() {
+    const double time = now();
+    float error = 0;
+    if (mode == PacingMode::TARGET) {
+        error = static_cast<float>((time - deadline) * 1000.0);
+        if (time - deadline >= period / 2) {
+            late++;
+        }
+        work = std::min(period, std::max(time - wokeAt, work * ESTIMATE_DECAY));
+        deadline += period;
+    }
+    if (lastShown > 0) {
+        intervals[head] = static_cast<float>((time - lastShown) * 1000.0);
+        errors[head] = error;
+        head = (head + 1) % PACING_HISTORY;
+        filled = std::min(filled + 1, PACING_HISTORY);
+    }
+    lastShown = time;
+}
+
+PacingStats FramePacer::getStats() const {
+    PacingStats stats{0, 0, 0, 0, 0, late, static_cast<float>(spin * 1000.0)};
+    if (filled == 0) {
+        return stats;
+    }
+    double total = 0;
+    double errorTotal = 0;
+    for (std::size_t i = 0; i < filled; ++i) {
+        total += intervals[i];
+        errorTotal += std::fabs(errors[i]);
+        stats.errorMaxMs = std::max(stats.errorMaxMs, std::fabs(errors[i]));
+    }
+    const double mean = total / filled;
+    double spread = 0;
+    for (std::size_t i = 0; i < filled; ++i) {
+        spread += (intervals[i] - mean) * (intervals[i] - mean);
+    }
+    stats.intervalMeanMs = static_cast<float>(mean);
+    stats.intervalStdDevMs = static_cast<float>(std::sqrt(spread / filled));
+    stats.fps = mean > 0 ? static_cast<float>(1000.0 / mean) : 0.f;
+    stats.errorMeanMs = static_cast<float>(errorTotal / filled);
+    return stats;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Frames the pacing statistics cover
+const std::size_t PACING_HISTORY = 240;
+
+enum class PacingMode {
+    // display() waits for the monitor's vertical blank
+    VSYNC,
+    // The pacer holds frames to a target rate
+    TARGET,
+    // Frames go out as fast as they are built
+    UNCAPPED
+};
+
+struct PacingStats {
+    // Frames shown per second, and the spread of the time between them
+    float fps;
+    float intervalMeanMs;
+    float intervalStdDevMs;
+    // TARGET only: how far from its deadline each frame reached the screen
+    // (mean of the absolute error, and the worst), and how many were half a
+    // period or more late
+    float errorMeanMs;
+    float errorMaxMs;
+    std::uint64_t late;
+    // How early the pacer stops sleeping and starts spinning
+    float spinMs;
+};
+
+// Frame pacer. In TARGET mode each frame has a deadline one period after the
+// last; wait() holds the frame back until just enough time is left to build
+// and show it by then, so input read after the wait is as fresh as it can
+// be. Sleeps only promise to wake up some time after they were asked to, so
+// the pacer sleeps until a little before that point and spins out the rest
+// on the clock; the spin margin follows the worst oversleep it has seen and
+// the work estimate the slowest recent frame, both easing off slowly. It
+// keeps its own pacing error and frame-time spread in every mode.
+class FramePacer {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PacingMode mode;
+    double targetHz;
+    double period;
+    Clock::time_point epoch;
+    // Seconds since epoch
+    double deadline;
+    double wokeAt;
+    double lastShown;
+    double work;
+    double spin;
+
+    float intervals[PACING_HISTORY];
+    float errors[PACING_HISTORY];
+    std::size_t head;
+    std::size_t filled;
+    std::uint64_t late;
+
+    double now() const;
+    void sleepUntil(double wake);
+
+public:
+    FramePacer();
+
+    // The rate only applies to TARGET; restarts the statistics
+    void setMode(PacingMode pacingMode, double hz = 60);
+    PacingMode getMode() const { return mode; }
+    double getTargetHz() const { return targetHz; }
+
+    // Before the frame reads its input
+    void wait();
+    // Right after display() returns
+    void shown();
+
+    PacingStats getStats() const;
+};
@@ -0,0 +1,178 @@
+#include "frame_profiler.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#include "../src/game_types.hpp"
+
+namespace {
+
+const float PANEL_WIDTH = 260.f;
+const float PANEL_HEIGHT = 300.f;
+const float PANEL_LEFT = 10.f;
+const float PANEL_TOP = HEIGHT - PANEL_HEIGHT - 10.f;
+const float GRAPH_BOTTOM = PANEL_TOP + PANEL_HEIGHT - 10.f;
+const float GRAPH_HEIGHT = 100.f;
+const float GRAPH_MS = 33.3f;
+const float DEFAULT_BUDGET_MS = 1000.f / 60.f;
+const float REFRESH_INTERVAL_MS = 250.f;
+
+const sf::Color PHASE_COLORS[FRAME_PHASE_COUNT] = {
+    sf::Color(80, 200, 255),
+    sf::Color(100, 220, 100),
+    sf::Color(255, 170, 60),
+    sf::Color(220, 90, 220),
+    sf::Color(110, 110, 110)
+};
+
+float elapsedMs(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - since).count();
+}
+
+}
+
+FrameProfiler::FrameProfiler(const sf::Font& font)
+    : history(PROFILER_HISTORY), head(0), filled(0), current(), activePhase(FramePhase::EVENTS),
+      appleCount(0), particleCount(0), voicesActive(0), voiceCapacity(0), voicePeak(0), voiceSteals(0), autopilot(false),
+      plannerDepth(0), plannerApples(0), plannerNodes(0), plannerMs(0), pacingMode(nullptr), pacing(), visible(false), refreshMs(REFRESH_INTERVAL_MS), text(font, "", 13),
+      graph(sf::PrimitiveType::Triangles, PROFILER_HISTORY * FRAME_PHASE_COUNT * 6) {
+    sorted.reserve(PROFILER_HISTORY);
+    summary[0] = '\0';
+
+    // Bar colors never change, only the vertex positions are rebuilt
+    for (std::size_t i = 0; i < graph.getVertexCount(); ++i) {
+        graph[i].color = PHASE_COLORS[(i / 6) % FRAME_PHASE_COUNT];
+    }
+
+    panel.setSize(sf::Vector2f(PANEL_WIDTH, PANEL_HEIGHT));
+    panel.setPosition(sf::Vector2f(PANEL_LEFT, PANEL_TOP));
+    panel.setFillColor(sf::Color(0, 0, 0, 190));
+
+    budgetLine.setSize(sf::Vector2f(static_cast<float>(PROFILER_HISTORY), 1.f));
+    budgetLine.setFillColor(sf::Color(255, 80, 80, 160));
+    setBudget(DEFAULT_BUDGET_MS);
+
+    text.setFillColor(sf::Color::White);
+    text.setPosition(sf::Vector2f(PANEL_LEFT + 10.f, PANEL_TOP + 6.f));
+}
+
+void FrameProfiler::setBudget(float ms) {
+    float height = std::min(ms, GRAPH_MS) / GRAPH_MS * GRAPH_HEIGHT;
+    budgetLine.setPosition(sf::Vector2f(PANEL_LEFT + 10.f, GRAPH_BOTTOM - height));
+}
+
+void FrameProfiler::beginFrame() {
+    current = Sample();
+    frameStart = Clock::now();
+}
+
+void FrameProfiler::endFrame() {
+    current.totalMs = elapsedMs(frameStart);
+    history[head] = current;
+    head = (head + 1) % PROFILER_HISTORY;
+    filled = std::min(filled + 1, PROFILER_HISTORY);
+    refreshMs += current.totalMs;
+}
+
+void FrameProfiler::beginPhase(FramePhase phase) {
+    activePhase = phase;
+    phaseStart = Clock::now();
+}
+
+void FrameProfiler::endPhase() {
+    current.phaseMs[static_cast<int>(activePhase)] += elapsedMs(phaseStart);
+}
+
+void FrameProfiler::refreshText() {
+    sorted.clear();
+    float phaseTotals[FRAME_PHASE_COUNT] = {};
+    for (std::size_t i = 0; i < filled; ++i) {
+        sorted.push_back(history[i].totalMs);
+        for (int phase = 0; phase < FRAME_PHASE_COUNT; ++phase) {
+            phaseTotals[phase] += history[i].phaseMs[phase];
+        }
+    }
+
+    auto percentile = [&](float p) {
+        auto nth = sorted.begin() + static_cast<std::ptrdiff_t>(p * (sorted.size() - 1) + 0.5f);
+        std::nth_element(sorted.begin(), nth, sorted.end());
+        return *nth;
+    };
+    float p50 = percentile(0.50f);
+    float p95 = percentile(0.95f);
+    float p99 = percentile(0.99f);
+
+    float count = static_cast<float>(filled);
+    const Sample& last = history[(head + PROFILER_HISTORY - 1) % PROFILER_HISTORY];
+    std::snprintf(summary, sizeof(summary),
+                  "frame ms  p50 %.2f  p95 %.2f  p99 %.2f\n"
+                  "mean ms   events %.2f  update %.2f\n"
+                  "          render %.2f  overlay %.2f\n"
+                  "          display %.2f\n"
+                  "apples %zu  particles %zu  draw calls %u\n"
+                  "voices %u/%u  peak %u  steals %llu",
+                  p50, p95, p99,
+                  phaseTotals[0] / count, phaseTotals[1] / count,
+                  phaseTotals[2] / count, phaseTotals[3] / count,
+                  phaseTotals[4] / count,
+                  appleCount, particleCount, last.drawCalls,
+                  voicesActive, voiceCapacity, voicePeak, static_cast<unsigned long long>(voiceSteals));
+    if (pacingMode) {
+        std::size_t used = std::strlen(summary);
+        std::snprintf(summary + used, sizeof(summary) - used,
+                      "\npacing %s  %.1f fps  sd %.2f ms\n          error %.2f  max %.2f ms  late %llu",
+                      pacingMode, pacing.fps, pacing.intervalStdDevMs, pacing.errorMeanMs, pacing.errorMaxMs,
+                      static_cast<unsigned long long>(pacing.late));
+    }
+    if (autopilot) {
+        std::size_t used = std::strlen(summary);
+        std::snprintf(summary + used, sizeof(summary) - used, "\nautopilot %d/%d apples  %zu nodes  %.2f ms",
+                      plannerDepth, plannerApples, plannerNodes, plannerMs);
+    }
+    text.setString(summary);
+}
+
+void FrameProfiler::rebuildGraph() {
+    // Oldest frame on the left; each bar stacks the phases bottom-up
+    std::size_t vertex = 0;
+    for (std::size_t bar = 0; bar < PROFILER_HISTORY; ++bar) {
+        const Sample& sample = history[(head + bar) % PROFILER_HISTORY];
+        bool recorded = bar + filled >= PROFILER_HISTORY;
+        float left = PANEL_LEFT + 10.f + static_cast<float>(bar);
+        float right = left + 1.f;
+        float bottom = GRAPH_BOTTOM;
+
+        for (int phase = 0; phase < FRAME_PHASE_COUNT; ++phase) {
+            float height = recorded ? sample.phaseMs[phase] / GRAPH_MS * GRAPH_HEIGHT : 0.f;
+            float top = std::max(GRAPH_BOTTOM - GRAPH_HEIGHT, bottom - height);
+
+            sf::Vertex* quad = &graph[vertex];
+            quad[0].position = sf::Vector2f(left, bottom);
+            quad[1].position = sf::Vector2f(right, bottom);
+            quad[2].position = sf::Vector2f(right, top);
+            quad[3].position = sf::Vector2f(left, bottom);
+            quad[4].position = sf::Vector2f(right, top);
+            quad[5].position = sf::Vector2f(left, top);
+            vertex += 6;
+            bottom = top;
+        }
+    }
+}
+
+void FrameProfiler::draw(sf::RenderTarget& target) {
+    if (!visible || filled == 0) {
+        return;
+    }
+    // Formatting reallocates the sf::Text string, so keep it off the per-frame path
+    if (refreshMs >= REFRESH_INTERVAL_MS) {
+        refreshText();
+        refreshMs = 0;
+    }
+    rebuildGraph();
+
+    target.draw(panel);
+    target.draw(graph);
+    target.draw(budgetLine);
+    target.draw(text);
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "frame_pacer.hpp"
+
+enum class FramePhase {
+    EVENTS,
+    UPDATE,
+    RENDER,
+    OVERLAY,
+    DISPLAY
+};
+
+const int FRAME_PHASE_COUNT = 5;
+const std::size_t PROFILER_HISTORY = 240;
+
+// Per-phase frame timer with a toggleable overlay (rolling percentiles, a
+// stacked frame-time graph, apple, draw call and sound voice counts, and
+// the frame pacer's rate, spread and error). Timing is a couple of
+// steady_clock reads per phase and always runs, so the numbers are ready the
+// moment the overlay is shown; text is only re-formatted a few times a second.
+class FrameProfiler {
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Sample {
+        float phaseMs[FRAME_PHASE_COUNT];
+        float totalMs;
+        unsigned drawCalls;
+    };
+
+    std::vector<Sample> history;
+    std::size_t head;
+    std::size_t filled;
+
+    Sample current;
+    Clock::time_point frameStart;
+    Clock::time_point phaseStart;
+    FramePhase activePhase;
+    std::size_t appleCount;
+    std::size_t particleCount;
+    unsigned voicesActive;
+    unsigned voiceCapacity;
+    unsigned voicePeak;
+    std::uint64_t voiceSteals;
+    bool autopilot;
+    int plannerDepth;
+    int plannerApples;
+    std::size_t plannerNodes;
+    float plannerMs;
+    // Null when the frame pacer is not in use
+    const char* pacingMode;
+    PacingStats pacing;
+
+    bool visible;
+    float refreshMs;
+    std::vector<float> sorted;
+    char summary[512];
+
+    sf::RectangleShape panel;
+    sf::RectangleShape budgetLine;
+    sf::Text text;
+    sf::VertexArray graph;
+
+    void refreshText();
+    void rebuildGraph();
+
+public:
+    explicit FrameProfiler(const sf::Font& font);
+
+    void beginFrame();
+    void endFrame();
+
+    // Time spent between begin and end is added to the phase, so a phase
+    // may be entered several times per frame (fixed-tick updates)
+    void beginPhase(FramePhase phase);
+    void endPhase();
+
+    void addDrawCalls(unsigned count) { current.drawCalls += count; }
+    void setAppleCount(std::size_t count) { appleCount = count; }
+    void setParticleCount(std::size_t count) { particleCount = count; }
+    void setVoiceStats(unsigned active, unsigned capacity, unsigned peak, std::uint64_t steals) {
+        voicesActive = active;
+        voiceCapacity = capacity;
+        voicePeak = peak;
+        voiceSteals = steals;
+    }
+    // The autopilot's plan coverage and last search; off hides the numbers
+    void setPlannerStats(bool enabled, int depth, int apples, std::size_t nodes, float ms) {
+        autopilot = enabled;
+        plannerDepth = depth;
+        plannerApples = apples;
+        plannerNodes = nodes;
+        plannerMs = ms;
+    }
+
+    // The pacer's mode and numbers; the label must outlive the profiler
+    void setPacing(const char* mode, const PacingStats& stats) {
+        pacingMode = mode;
+        pacing = stats;
+    }
+    // The frame budget the graph marks, for the display rate in use
+    void setBudget(float ms);
+
+    void toggle() { visible = !visible; }
+    bool isVisible() const { return visible; }
+
+    void draw(sf::RenderTarget& target);
+};
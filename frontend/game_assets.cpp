@@ -0,0 +1,101 @@
+#include "game_assets.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/mapped_file.hpp"
+#include "../src/thread_pool.hpp"
+
+namespace {
+
+const char* const SOUND_NAMES[GAME_SOUND_COUNT] = {
+    "collect_sound", "miss_sound", "gameover_sound", "victory_sound"
+};
+
+// Where one asset comes from: an entry of the pack or a loose file
+struct AssetSlot {
+    const std::uint8_t* data = nullptr;
+    std::size_t size = 0;
+    std::string path;
+
+    bool present() const { return data || !path.empty(); }
+};
+
+void report(const char* name, bool loaded) {
+    if (!loaded) {
+        std::fprintf(stderr, "cannot load asset '%s'\n", name);
+    }
+}
+
+}
+
+GameAssets::GameAssets(const std::string& packPath) : packed(false) {
+    std::string error;
+    packed = pack.open(packPath, error);
+    std::vector<AssetSource> loose;
+    if (!packed) {
+        loose = resolveGameAssets();
+    }
+    auto slot = [&](const char* name) {
+        AssetSlot result;
+        if (packed) {
+            if (const AssetEntry* entry = pack.find(name)) {
+                result.data = entry->data;
+                result.size = entry->size;
+            }
+        } else {
+            for (const AssetSource& source : loose) {
+                if (source.name == name) {
+                    result.path = source.path;
+                }
+            }
+        }
+        return result;
+    };
+
+    // The pool is sized to the work: one thread per asset at most
+    unsigned threads = std::min(static_cast<unsigned>(GAME_SOUND_COUNT + 2),
+                                std::max(1u, std::thread::hardware_concurrency()));
+    ThreadPool pool(threads);
+
+    AssetSlot fontSlot = slot("font");
+    if (fontSlot.present()) {
+        pool.submit([this, fontSlot] {
+            report("font", fontSlot.data ? font.openFromMemory(fontSlot.data, fontSlot.size)
+                                         : font.openFromFile(fontSlot.path));
+        });
+    }
+    AssetSlot musicSlot = slot("music");
+    if (musicSlot.present()) {
+        pool.submit([this, musicSlot] {
+            report("music", musicSlot.data ? music.openFromMemory(musicSlot.data, musicSlot.size)
+                                           : music.openFromFile(musicSlot.path));
+        });
+    }
+    for (int s = 0; s < GAME_SOUND_COUNT; ++s) {
+        AssetSlot soundSlot = slot(SOUND_NAMES[s]);
+        if (!soundSlot.present()) {
+            continue;
+        }
+        pool.submit([this, s, soundSlot] {
+            sf::SoundBuffer& buffer = sounds[s];
+            report(SOUND_NAMES[s], soundSlot.data ? buffer.loadFromMemory(soundSlot.data, soundSlot.size)
+                                                  : buffer.loadFromFile(soundSlot.path));
+        });
+    }
+    AssetSlot scriptSlot = slot("intro_script");
+    if (scriptSlot.data) {
+        introScript.assign(reinterpret_cast<const char*>(scriptSlot.data), scriptSlot.size);
+    } else if (!scriptSlot.path.empty()) {
+        MappedFile file;
+        std::string fileError;
+        if (file.open(scriptSlot.path, fileError)) {
+            introScript.assign(reinterpret_cast<const char*>(file.getData()), file.getSize());
+        }
+    }
+    pool.wait();
+}
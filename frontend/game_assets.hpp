@@ -0,0 +1,45 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+#include <string>
+
+#include "../src/asset_pack.hpp"
+
+enum class GameSound {
+    COLLECT,
+    MISS,
+    GAME_OVER,
+    VICTORY
+};
+
+const int GAME_SOUND_COUNT = 4;
+
+// The font, music, sound buffers and intro script, loaded once at startup. They come from
+// the asset pack, mapped in one go, with the font, music and every sound
+// buffer decoded on its own worker thread. Without a pack (a fresh checkout
+// before `make assets.pak`) the same decode runs on the loose files. The font
+// and music read straight from the mapping, so the pack lives as long as this.
+class GameAssets {
+private:
+    AssetPack pack;
+    bool packed;
+    sf::Font font;
+    sf::Music music;
+    sf::SoundBuffer sounds[GAME_SOUND_COUNT];
+    std::string introScript;
+
+public:
+    explicit GameAssets(const std::string& packPath);
+
+    GameAssets(const GameAssets&) = delete;
+    GameAssets& operator=(const GameAssets&) = delete;
+
+    const sf::Font& getFont() const { return font; }
+    sf::Music& getMusic() { return music; }
+    const sf::SoundBuffer& getSound(GameSound sound) const { return sounds[static_cast<int>(sound)]; }
+    // Empty if the script is missing
+    const std::string& getIntroScript() const { return introScript; }
+
+    bool isPacked() const { return packed; }
+};
@@ -0,0 +1,167 @@
+#include "hud_layer.hpp"
+
+#include <string>
+
+#include "apple_batch.hpp"
+
+namespace {
+
+// The cache holds colors already multiplied by their alpha (the result of
+// alpha-blending onto a transparent target), so it is composited with
+// One/OneMinusSrcAlpha to land exactly as if drawn straight to the window.
+const sf::BlendMode PREMULTIPLIED_ALPHA(sf::BlendMode::Factor::One, sf::BlendMode::Factor::OneMinusSrcAlpha);
+
+sf::Color desireBarColor(int value) {
+    if (value < MIN_DESIRE) {
+        return sf::Color(200, 50, 50);
+    } else if (value > MAX_DESIRE) {
+        return sf::Color(255, 50, 0);
+    } else if (value < 40) {
+        return sf::Color(255, 200, 0);
+    } else if (value > 70) {
+        return sf::Color(255, 165, 0);
+    }
+    return sf::Color(50, 205, 50);
+}
+
+}
+
+HudLayer::HudLayer(const sf::Font& font)
+    : cacheAvailable(false), valid(false), cachedValue(0), cachedMinSafe(0), cachedMaxSafe(0),
+      rebuildCount(0),
+      titleText(font, "BALANCE OF DESIRE", 32),
+      minDesireLabel(font, std::to_string(MIN_DESIRE), 18),
+      maxDesireLabel(font, std::to_string(MAX_DESIRE), 18) {
+    if (texture.resize(sf::Vector2u(WIDTH, HEIGHT))) {
+        sprite = std::make_unique<sf::Sprite>(texture.getTexture());
+        cacheAvailable = true;
+    }
+
+    uiPanel.setSize(sf::Vector2f(WIDTH, 120.f));
+    uiPanel.setFillColor(sf::Color(20, 20, 30, 230));
+    uiPanel.setPosition(sf::Vector2f(0.f, 0.f));
+
+    titleText.setFillColor(sf::Color(255, 215, 0));
+    titleText.setStyle(sf::Text::Bold);
+    titleText.setPosition(sf::Vector2f(WIDTH / 2.f - 180.f, 10.f));
+
+    desireBarBorder.setSize(sf::Vector2f(304.f, 24.f));
+    desireBarBorder.setFillColor(sf::Color::Transparent);
+    desireBarBorder.setOutlineThickness(3.f);
+    desireBarBorder.setOutlineColor(sf::Color(200, 200, 200));
+    desireBarBorder.setPosition(sf::Vector2f(WIDTH / 2.f - 150.f, 85.f));
+
+    desireBarBg.setSize(sf::Vector2f(300.f, 20.f));
+    desireBarBg.setFillColor(sf::Color(40, 40, 50));
+    desireBarBg.setPosition(sf::Vector2f(WIDTH / 2.f - 148.f, 87.f));
+
+    desireBar.setSize(sf::Vector2f(300.f, 20.f));
+    desireBar.setFillColor(sf::Color::Green);
+    desireBar.setPosition(sf::Vector2f(WIDTH / 2.f - 148.f, 87.f));
+
+    safeMarkerLeft.setSize(sf::Vector2f(2.f, 26.f));
+    safeMarkerLeft.setFillColor(sf::Color::White);
+    safeMarkerRight.setSize(sf::Vector2f(2.f, 26.f));
+    safeMarkerRight.setFillColor(sf::Color::White);
+
+    minDesireLabel.setFillColor(sf::Color(255, 255, 100));
+    minDesireLabel.setStyle(sf::Text::Bold);
+    maxDesireLabel.setFillColor(sf::Color(255, 255, 100));
+    maxDesireLabel.setStyle(sf::Text::Bold);
+
+    legendPanel.setSize(sf::Vector2f(WIDTH, 60.f));
+    legendPanel.setFillColor(sf::Color(20, 20, 30, 230));
+    legendPanel.setPosition(sf::Vector2f(0.f, HEIGHT - 60.f));
+
+    float legendY = HEIGHT - 35.f;
+    float legendStartX = 30.f;
+    float spacing = 235.f;
+    const AppleType legendTypes[] = {AppleType::RED, AppleType::GOLDEN, AppleType::ROTTEN};
+    const char* legendLines[] = {
+        "Red: +20 score, +20 desire",
+        "Gold: +80 score, -10 desire",
+        "Rotten: +5 score, +40 desire"
+    };
+
+    for (int i = 0; i < 3; ++i) {
+        sf::CircleShape circle(10.f);
+        circle.setFillColor(appleColor(legendTypes[i]));
+        circle.setPosition(sf::Vector2f(legendStartX + spacing * i, legendY));
+        legendCircles.push_back(circle);
+
+        sf::Text text(font, legendLines[i], 16);
+        text.setFillColor(sf::Color::White);
+        text.setPosition(sf::Vector2f(legendStartX + spacing * i + 25.f, legendY - 2.f));
+        legendTexts.push_back(text);
+    }
+
+    sf::Text missedText(font, "Missed: -10 desire", 16);
+    missedText.setFillColor(sf::Color(255, 100, 100));
+    missedText.setPosition(sf::Vector2f(legendStartX + spacing * 3 + 5.f, legendY - 2.f));
+    legendTexts.push_back(missedText);
+}
+
+void HudLayer::layout(const DesireGauge& desire) {
+    float desirePercent = desire.value / 100.0f;
+    desireBar.setSize(sf::Vector2f(300.f * desirePercent, 20.f));
+    desireBar.setFillColor(desireBarColor(desire.value));
+
+    float safeStartX = WIDTH / 2.f - 148.f + (desire.minSafe * 3.f);
+    float safeEndX = WIDTH / 2.f - 148.f + (desire.maxSafe * 3.f);
+    safeMarkerLeft.setPosition(sf::Vector2f(safeStartX, 86.f));
+    safeMarkerRight.setPosition(sf::Vector2f(safeEndX, 86.f));
+
+    minDesireLabel.setString(std::to_string(desire.minSafe));
+    maxDesireLabel.setString(std::to_string(desire.maxSafe));
+    sf::FloatRect minBounds = minDesireLabel.getLocalBounds();
+    minDesireLabel.setPosition(sf::Vector2f(safeStartX - minBounds.size.x - 8.f, 85.f));
+    maxDesireLabel.setPosition(sf::Vector2f(safeEndX + 8.f, 85.f));
+}
+
+unsigned HudLayer::drawChrome(sf::RenderTarget& target, const sf::RenderStates& states) const {
+    target.draw(uiPanel, states);
+    target.draw(legendPanel, states);
+    target.draw(titleText, states);
+    target.draw(desireBarBg, states);
+    target.draw(desireBar, states);
+    target.draw(desireBarBorder, states);
+    target.draw(safeMarkerLeft, states);
+    target.draw(safeMarkerRight, states);
+    target.draw(minDesireLabel, states);
+    target.draw(maxDesireLabel, states);
+    for (const auto& circle : legendCircles) {
+        target.draw(circle, states);
+    }
+    for (const auto& text : legendTexts) {
+        target.draw(text, states);
+    }
+    return 10 + static_cast<unsigned>(legendCircles.size() + legendTexts.size());
+}
+
+void HudLayer::update(const DesireGauge& desire) {
+    if (valid && desire.value == cachedValue &&
+        desire.minSafe == cachedMinSafe && desire.maxSafe == cachedMaxSafe) {
+        return;
+    }
+
+    layout(desire);
+    cachedValue = desire.value;
+    cachedMinSafe = desire.minSafe;
+    cachedMaxSafe = desire.maxSafe;
+    valid = true;
+
+    if (cacheAvailable) {
+        texture.clear(sf::Color::Transparent);
+        drawChrome(texture, sf::RenderStates::Default);
+        texture.display();
+        rebuildCount++;
+    }
+}
+
+unsigned HudLayer::draw(sf::RenderTarget& target) const {
+    if (!cacheAvailable) {
+        return drawChrome(target, sf::RenderStates::Default);
+    }
+    target.draw(*sprite, sf::RenderStates(PREMULTIPLIED_ALPHA));
+    return 1;
+}
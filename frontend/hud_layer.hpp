@@ -0,0 +1,53 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <vector>
+
+#include "../src/simulation.hpp"
+
+// Static HUD chrome (panels, title, desire bar with its safe-zone markers and
+// labels, legend) baked into an offscreen texture. The texture is only redrawn
+// when the desire gauge or its safe range changes; every other frame the
+// whole layer is one sprite draw.
+class HudLayer {
+private:
+    sf::RenderTexture texture;
+    std::unique_ptr<sf::Sprite> sprite;
+    bool cacheAvailable;
+    bool valid;
+    int cachedValue;
+    int cachedMinSafe;
+    int cachedMaxSafe;
+    unsigned rebuildCount;
+
+    sf::RectangleShape uiPanel;
+    sf::RectangleShape legendPanel;
+    sf::Text titleText;
+    sf::RectangleShape desireBar;
+    sf::RectangleShape desireBarBg;
+    sf::RectangleShape desireBarBorder;
+    sf::RectangleShape safeMarkerLeft;
+    sf::RectangleShape safeMarkerRight;
+    sf::Text minDesireLabel;
+    sf::Text maxDesireLabel;
+    std::vector<sf::CircleShape> legendCircles;
+    std::vector<sf::Text> legendTexts;
+
+    void layout(const DesireGauge& desire);
+    unsigned drawChrome(sf::RenderTarget& target, const sf::RenderStates& states) const;
+
+public:
+    explicit HudLayer(const sf::Font& font);
+
+    // Redraws the cached texture if the gauge or its safe range moved
+    void update(const DesireGauge& desire);
+
+    // Forces a rebuild on the next update, e.g. after the font changes
+    void invalidate() { valid = false; }
+
+    // Returns the number of draw calls issued
+    unsigned draw(sf::RenderTarget& target) const;
+
+    unsigned getRebuildCount() const { return rebuildCount; }
+};
@@ -0,0 +1,76 @@
+#include "hud_text.hpp"
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#include "../src/game_types.hpp"
+
+DirtyText::DirtyText(const sf::Font& font, unsigned characterSize)
+    : text(font, "", characterSize) {
+    current[0] = '\0';
+}
+
+bool DirtyText::format(const char* pattern, ...) {
+    char formatted[sizeof(current)];
+    va_list args;
+    va_start(args, pattern);
+    std::vsnprintf(formatted, sizeof(formatted), pattern, args);
+    va_end(args);
+
+    if (std::strcmp(formatted, current) == 0) {
+        return false;
+    }
+    std::memcpy(current, formatted, sizeof(current));
+    text.setString(current);
+    return true;
+}
+
+Notification::Notification(const sf::Font& font, sf::Color fillColor)
+    : text(font, "", 24), shadow(font, "", 24), color(fillColor),
+      shownAt(0), duration(0), active(false), halfWidth(0) {
+    current[0] = '\0';
+    text.setStyle(sf::Text::Bold);
+    shadow.setStyle(sf::Text::Bold);
+}
+
+void Notification::show(const char* message, float now, float seconds) {
+    if (std::strcmp(message, current) != 0) {
+        std::snprintf(current, sizeof(current), "%s", message);
+        text.setString(current);
+        shadow.setString(current);
+        halfWidth = text.getLocalBounds().size.x / 2.f;
+    }
+    shownAt = now;
+    duration = seconds;
+    active = true;
+}
+
+unsigned Notification::draw(sf::RenderTarget& target, float yOffset, float now) {
+    if (!active) {
+        return 0;
+    }
+
+    float shown = now - shownAt;
+    float left = duration - shown;
+    float alpha = 255.f;
+    if (shown < 0.5f) {
+        alpha = 255.f * shown / 0.5f;
+    } else if (left < 0.5f) {
+        alpha = 255.f * left / 0.5f;
+    }
+    alpha = std::max(0.f, std::min(255.f, alpha));
+
+    sf::Color fill = color;
+    fill.a = static_cast<std::uint8_t>(alpha);
+    text.setFillColor(fill);
+    text.setPosition(sf::Vector2f(WIDTH / 2.f - halfWidth, HEIGHT / 2.f - 100.f + yOffset));
+
+    shadow.setFillColor(sf::Color(0, 0, 0, static_cast<std::uint8_t>(alpha * 0.8f)));
+    shadow.setPosition(sf::Vector2f(WIDTH / 2.f - halfWidth + 2.f, HEIGHT / 2.f - 98.f + yOffset));
+
+    target.draw(shadow);
+    target.draw(text);
+    return 2;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+// An sf::Text fed through a fixed buffer: format() only reaches setString()
+// (and its allocation) when the formatted text actually changes.
+class DirtyText {
+private:
+    sf::Text text;
+    char current[64];
+
+public:
+    DirtyText(const sf::Font& font, unsigned characterSize);
+
+    // printf-style; returns true if the displayed string changed
+    bool format(const char* pattern, ...);
+
+    sf::Text& get() { return text; }
+    const sf::Text& get() const { return text; }
+};
+
+// A centered, shadowed message that fades in and out over its duration.
+// The text objects persist; show() only restrings them. It keeps no timer of
+// its own: the fade is worked out from the session clock when drawn, and the
+// owner clears it when its expiry comes due.
+class Notification {
+private:
+    sf::Text text;
+    sf::Text shadow;
+    sf::Color color;
+    char current[64];
+    float shownAt;
+    float duration;
+    bool active;
+    float halfWidth;
+
+public:
+    Notification(const sf::Font& font, sf::Color fillColor);
+
+    // now is the session clock in seconds
+    void show(const char* message, float now, float seconds);
+    void clear() { active = false; }
+    bool isActive() const { return active; }
+
+    // Returns the number of draw calls issued
+    unsigned draw(sf::RenderTarget& target, float yOffset, float now);
+};
@@ -0,0 +1,79 @@
+#include "input_latency.hpp"
+
+#include <algorithm>
+
+InputLatency::InputLatency() : pending{}, pendingCount(0), lostTaps(0) {
+    samples.reserve(1024);
+}
+
+void InputLatency::remove(std::size_t index) {
+    pending[index] = pending[--pendingCount];
+}
+
+void InputLatency::press(int control, double stamp) {
+    if (pendingCount < LATENCY_PENDING) {
+        pending[pendingCount++] = Press{stamp, control, false, false};
+    }
+}
+
+void InputLatency::release(int control) {
+    for (std::size_t i = 0; i < pendingCount; ++i) {
+        if (pending[i].control == control) {
+            pending[i].released = true;
+        }
+    }
+}
+
+void InputLatency::seen(int control, double until) {
+    Press* oldest = nullptr;
+    for (std::size_t i = 0; i < pendingCount; ++i) {
+        Press& press = pending[i];
+        if (press.control == control && !press.seen && press.stamp < until &&
+            (!oldest || press.stamp < oldest->stamp)) {
+            oldest = &press;
+        }
+    }
+    if (oldest) {
+        oldest->seen = true;
+    }
+}
+
+void InputLatency::settle(double until) {
+    for (std::size_t i = 0; i < pendingCount;) {
+        if (!pending[i].seen && pending[i].released && pending[i].stamp < until) {
+            lostTaps++;
+            remove(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void InputLatency::displayed(double time) {
+    for (std::size_t i = 0; i < pendingCount;) {
+        if (pending[i].seen) {
+            samples.push_back(static_cast<float>((time - pending[i].stamp) * 1000.0));
+            remove(i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+LatencyReport InputLatency::report() {
+    LatencyReport result{samples.size(), 0, 0, 0, 0, lostTaps};
+    if (samples.empty()) {
+        return result;
+    }
+    sorted.assign(samples.begin(), samples.end());
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0;
+    for (float sample : sorted) {
+        total += sample;
+    }
+    result.meanMs = static_cast<float>(total / sorted.size());
+    result.p50Ms = sorted[sorted.size() / 2];
+    result.p95Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+    result.maxMs = sorted.back();
+    return result;
+}
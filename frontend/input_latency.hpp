@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Presses awaiting their first displayed frame; more are dropped unmeasured
+const std::size_t LATENCY_PENDING = 16;
+
+struct LatencyReport {
+    std::size_t samples;
+    float meanMs;
+    float p50Ms;
+    float p95Ms;
+    float maxMs;
+    // Presses released before any tick saw them
+    std::size_t lostTaps;
+};
+
+// --input-latency: times every movement key press from the moment it was
+// read to the end of the display() of the first frame that moved the basket
+// for it, and counts taps that never moved it at all. Controls are
+// player * 2 + direction. Times are seconds on the game's input clock.
+class InputLatency {
+private:
+    struct Press {
+        double stamp;
+        int control;
+        bool seen;
+        bool released;
+    };
+
+    Press pending[LATENCY_PENDING];
+    std::size_t pendingCount;
+    std::vector<float> samples;
+    std::vector<float> sorted;
+    std::size_t lostTaps;
+
+    void remove(std::size_t index);
+
+public:
+    InputLatency();
+
+    void press(int control, double stamp);
+    void release(int control);
+    // A tick ending at `until` moved the basket for the control, which
+    // accounts for its oldest unseen press made before then
+    void seen(int control, double until);
+    // After the frame's ticks: presses made before `until` that are already
+    // released and were never seen are lost
+    void settle(double until);
+    // The frame is on screen; every seen press gets its sample
+    void displayed(double time);
+    // Forgets presses in flight, when the game stops taking input
+    void clear() { pendingCount = 0; }
+
+    std::size_t getSampleCount() const { return samples.size(); }
+    LatencyReport report();
+};
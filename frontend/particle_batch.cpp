@@ -0,0 +1,42 @@
+#include "particle_batch.hpp"
+
+ParticleBatch::ParticleBatch() : vertices(sf::PrimitiveType::Triangles), used(0) {}
+
+void ParticleBatch::addParticles(const ParticleField& particles, float speedLag) {
+    const std::size_t needed = used + particles.size() * 6;
+    if (vertices.getVertexCount() < needed) {
+        vertices.resize(needed * 2);
+    }
+
+    for (std::size_t i = 0; i < particles.size(); ++i) {
+        float r = particles.radius[i];
+        float left = particles.x[i] - particles.vx[i] * speedLag - r;
+        float top = particles.y[i] - particles.vy[i] * speedLag - r;
+        float right = left + r * 2.f;
+        float bottom = top + r * 2.f;
+
+        sf::Color color(particles.color[i]);
+        float fade = 1.f - particles.age[i] / particles.life[i];
+        color.a = static_cast<std::uint8_t>(color.a * (fade > 0.f ? fade : 0.f));
+
+        sf::Vertex* quad = &vertices[used];
+        quad[0].position = sf::Vector2f(left, top);
+        quad[1].position = sf::Vector2f(right, top);
+        quad[2].position = sf::Vector2f(right, bottom);
+        quad[3].position = sf::Vector2f(left, top);
+        quad[4].position = sf::Vector2f(right, bottom);
+        quad[5].position = sf::Vector2f(left, bottom);
+        for (int v = 0; v < 6; ++v) {
+            quad[v].color = color;
+        }
+        used += 6;
+    }
+}
+
+unsigned ParticleBatch::draw(sf::RenderTarget& target) const {
+    if (used == 0) {
+        return 0;
+    }
+    target.draw(&vertices[0], used, sf::PrimitiveType::Triangles);
+    return 1;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+#include <cstddef>
+
+#include "../src/particle_field.hpp"
+
+// A whole ParticleField as one triangle list: each particle is a square of
+// two triangles whose alpha fades out over its life. Like AppleBatch the
+// vertex array only grows, so steady-state frames do not allocate.
+class ParticleBatch {
+private:
+    sf::VertexArray vertices;
+    std::size_t used;
+
+public:
+    ParticleBatch();
+
+    void clear() { used = 0; }
+
+    // speedLag pulls each particle back along its velocity, as AppleBatch does
+    // for apples, to place it between simulation ticks
+    void addParticles(const ParticleField& particles, float speedLag = 0.f);
+
+    // Returns the number of draw calls issued (0 or 1)
+    unsigned draw(sf::RenderTarget& target) const;
+};
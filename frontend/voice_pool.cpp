@@ -0,0 +1,70 @@
+#include "voice_pool.hpp"
+
+VoicePool::VoicePool(const std::vector<SoundEffect>& effects, std::uint64_t seed)
+    : rng(seed, AUDIO_STREAM), plays(0), steals(0), peak(0) {
+    std::size_t total = 0;
+    for (const SoundEffect& effect : effects) {
+        total += effect.voices > 0 ? effect.voices : 1;
+    }
+    voices.reserve(total);
+    startedAt.assign(total, 0);
+
+    for (const SoundEffect& effect : effects) {
+        Slice slice{voices.size(), effect.voices > 0 ? effect.voices : 1, effect.volume,
+                    effect.pitchJitter, effect.volumeJitter};
+        for (std::size_t v = 0; v < slice.count; ++v) {
+            voices.emplace_back(*effect.buffer);
+        }
+        slices.push_back(slice);
+    }
+}
+
+void VoicePool::play(int effect) {
+    const Slice& slice = slices[static_cast<std::size_t>(effect)];
+    std::size_t chosen = slice.first;
+    bool idle = false;
+    for (std::size_t v = slice.first; v < slice.first + slice.count; ++v) {
+        if (voices[v].getStatus() != sf::SoundSource::Status::Playing) {
+            chosen = v;
+            idle = true;
+            break;
+        }
+        if (startedAt[v] < startedAt[chosen]) {
+            chosen = v;
+        }
+    }
+    if (!idle) {
+        steals++;
+    }
+
+    sf::Sound& voice = voices[chosen];
+    voice.setPitch(1.f + (rng.uniformFloat() * 2.f - 1.f) * slice.pitchJitter);
+    voice.setVolume(slice.volume * (1.f - rng.uniformFloat() * slice.volumeJitter));
+    voice.play();
+    startedAt[chosen] = ++plays;
+
+    unsigned active = activeVoices();
+    if (active > peak) {
+        peak = active;
+    }
+}
+
+void VoicePool::stopAll() {
+    for (sf::Sound& voice : voices) {
+        voice.stop();
+    }
+}
+
+unsigned VoicePool::activeVoices() const {
+    unsigned active = 0;
+    for (const sf::Sound& voice : voices) {
+        if (voice.getStatus() == sf::SoundSource::Status::Playing) {
+            active++;
+        }
+    }
+    return active;
+}
+
+VoiceStats VoicePool::getStats() const {
+    return VoiceStats{static_cast<unsigned>(voices.size()), activeVoices(), peak, plays, steals};
+}
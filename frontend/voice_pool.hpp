@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "../src/random.hpp"
+
+// One kind of sound the pool plays: its buffer, how many voices it gets and
+// how much each play may stray from the base pitch (+-) and volume (-)
+struct SoundEffect {
+    const sf::SoundBuffer* buffer;
+    unsigned voices;
+    float volume;
+    float pitchJitter;
+    float volumeJitter;
+};
+
+struct VoiceStats {
+    unsigned capacity;
+    unsigned active;
+    unsigned peak;
+    std::uint64_t plays;
+    std::uint64_t steals;
+};
+
+// Every voice is created up front and bound to its effect's buffer for good,
+// so play() never allocates or rebinds. Each effect owns its own slice of
+// voices; when all of them are busy the one started longest ago is stolen,
+// so a storm of catches plays every catch and can never cut off the
+// game-over sting.
+class VoicePool {
+private:
+    struct Slice {
+        std::size_t first;
+        std::size_t count;
+        float volume;
+        float pitchJitter;
+        float volumeJitter;
+    };
+
+    std::vector<sf::Sound> voices;
+    std::vector<std::uint64_t> startedAt;
+    std::vector<Slice> slices;
+    CounterRng rng;
+    std::uint64_t plays;
+    std::uint64_t steals;
+    unsigned peak;
+
+public:
+    // Effect ids are indices into effects
+    VoicePool(const std::vector<SoundEffect>& effects, std::uint64_t seed);
+
+    VoicePool(const VoicePool&) = delete;
+    VoicePool& operator=(const VoicePool&) = delete;
+
+    void play(int effect);
+    void stopAll();
+
+    unsigned activeVoices() const;
+    VoiceStats getStats() const;
+};
@@ -1,20 +1,38 @@
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <random>
 #include <memory>
 
-// Constants
-const int WIDTH = 1000;
-const int HEIGHT = 700;
-const float PLAYER_SPEED = 8.0f;
-const float APPLE_FALL_SPEED = 3.375f;
-const int MIN_DESIRE = 30;
-const int MAX_DESIRE = 80;
-const int GAME_DURATION = 180;
+#include "frontend/alloc_counter.hpp"
+#include "frontend/apple_batch.hpp"
+#include "frontend/frame_capture.hpp"
+#include "frontend/frame_pacer.hpp"
+#include "frontend/frame_profiler.hpp"
+#include "frontend/game_assets.hpp"
+#include "frontend/hud_layer.hpp"
+#include "frontend/hud_text.hpp"
+#include "frontend/input_latency.hpp"
+#include "frontend/particle_batch.hpp"
+#include "frontend/voice_pool.hpp"
+#include "src/intro_scene.hpp"
+#include "src/key_timeline.hpp"
+#include "src/lookahead_planner.hpp"
+#include "src/particle_field.hpp"
+#include "src/replay.hpp"
+#include "src/simulation.hpp"
+#include "src/thread_pool.hpp"
+#include "src/timer_wheel.hpp"
+#include "src/video_encoder.hpp"
 
 enum class GameState {
     INTRO,
@@ -24,108 +42,207 @@ enum class GameState {
     VICTORY
 };
 
-enum class AppleType {
-    RED,
-    GOLDEN,
-    ROTTEN
-};
+// Longest wall-clock frame fed to the simulation; a longer stall (window drag,
+// breakpoint) slows the game down instead of fast-forwarding it
+const float MAX_FRAME_TIME = 0.25f;
 
-struct Apple {
-    sf::CircleShape shape;
-    AppleType type;
-    float speed;
-    bool active;
+// Session timer wheel events
+const std::uint32_t RANGE_NOTIFICATION_EXPIRY = 0;
+const std::uint32_t SPEED_NOTIFICATION_EXPIRY = 1;
+const std::uint32_t PLAYER_OUT_NOTIFICATION_EXPIRY = 2;
+const int NOTIFICATION_COUNT = 3;
+const float NOTIFICATION_SECONDS = 3.0f;
 
-    Apple(float x, float y, AppleType t) : type(t), speed(APPLE_FALL_SPEED), active(true) {
-        shape.setRadius(15.0f);
-        shape.setPosition(sf::Vector2f(x, y));
-        
-        switch(type) {
-            case AppleType::RED:
-                shape.setFillColor(sf::Color(220, 20, 60));
-                break;
-            case AppleType::GOLDEN:
-                shape.setFillColor(sf::Color(255, 215, 0));
-                break;
-            case AppleType::ROTTEN:
-                shape.setFillColor(sf::Color(101, 67, 33));
-                break;
-        }
-    }
+// Wall-clock search time the autopilot gets per frame, and how long a soak
+// run (--autopilot) shows the end screen before the next game
+const float AUTOPILOT_BUDGET_MS = 1.0f;
+const float SOAK_RESTART_SECONDS = 3.0f;
 
-    void update() {
-        if (active) {
-            shape.move(sf::Vector2f(0.f, speed));
-        }
-    }
+// --record frame rate, which an offscreen export also steps the game at, and
+// how much of the end screen an export keeps before it stops
+const unsigned VIDEO_FPS = 60;
+const float VIDEO_TAIL_SECONDS = 2.0f;
 
-    bool isOffScreen() const {
-        return shape.getPosition().y > HEIGHT;
-    }
+// Frame rates F4 steps through, then uncapped and vsync
+const double PACING_RATES[] = {60, 120, 144, 240};
+const int PACING_RATE_COUNT = 4;
 
-    sf::FloatRect getBounds() const {
-        return shape.getGlobalBounds();
-    }
+// --input-latency prints a summary every this many presses
+const std::size_t LATENCY_REPORT_EVERY = 50;
+
+// Voices per effect: enough for a storm's worth of overlapping catches
+const unsigned COLLECT_VOICES = 8;
+const unsigned MISS_VOICES = 4;
+
+// Particle effects, velocities in pixels per reference frame; screen up is -pi/2.
+// Catch sparks take the colour of the apple caught.
+const float PARTICLE_UP = -1.5707964f;
+const float PARTICLE_ALL_WAYS = 3.1415927f;
+const ParticleBurst CATCH_SPARKS = {24, PARTICLE_UP, 1.2f, 1.5f, 5.f, 0.3f, 0.7f, 1.5f, 3.f, 0.15f, 0};
+const ParticleBurst GOLDEN_SPARKS = {48, PARTICLE_UP, PARTICLE_ALL_WAYS, 2.f, 6.f, 0.5f, 1.1f, 1.5f, 3.5f, 0.05f, 0xFFE66EFF};
+const ParticleBurst ROTTEN_MIST = {32, PARTICLE_UP, 1.6f, 0.3f, 1.5f, 0.8f, 1.6f, 4.f, 8.f, -0.01f, 0x3C281ECC};
+const ParticleBurst MISS_DUST = {16, PARTICLE_UP, 1.1f, 1.f, 3.f, 0.3f, 0.6f, 1.5f, 3.f, 0.12f, 0x8C785ACC};
+// Left behind every tick by golden and rotten intro apples
+const ParticleBurst GOLDEN_TRAIL = {1, 0.f, PARTICLE_ALL_WAYS, 0.2f, 1.f, 0.4f, 0.8f, 1.f, 2.5f, 0.f, 0xFFD700B4};
+const ParticleBurst ROTTEN_TRAIL = {1, PARTICLE_UP, PARTICLE_ALL_WAYS, 0.1f, 0.5f, 0.6f, 1.2f, 4.f, 7.f, -0.005f, 0x32201E78};
+
+// Left/right keys per player. A lone player can also use A/D.
+struct PlayerKeys {
+    sf::Keyboard::Key left;
+    sf::Keyboard::Key right;
+};
+
+const PlayerKeys PLAYER_KEYS[MAX_PLAYERS] = {
+    {sf::Keyboard::Key::Left, sf::Keyboard::Key::Right},
+    {sf::Keyboard::Key::A, sf::Keyboard::Key::D},
+    {sf::Keyboard::Key::J, sf::Keyboard::Key::L},
+    {sf::Keyboard::Key::Numpad4, sf::Keyboard::Key::Numpad6},
+    {sf::Keyboard::Key::Z, sf::Keyboard::Key::C},
+    {sf::Keyboard::Key::Q, sf::Keyboard::Key::E},
+    {sf::Keyboard::Key::U, sf::Keyboard::Key::O},
+    {sf::Keyboard::Key::Numpad1, sf::Keyboard::Key::Numpad3},
+};
+
+const char* const PLAYER_KEY_NAMES[MAX_PLAYERS] = {
+    "Arrows", "A/D", "J/L", "Num 4/6", "Z/C", "Q/E", "U/O", "Num 1/3"
+};
+
+// Basket fill per player; player 1 keeps the single-player brown
+const sf::Color PLAYER_COLORS[MAX_PLAYERS] = {
+    sf::Color(139, 69, 19), sf::Color(40, 110, 220), sf::Color(60, 170, 70), sf::Color(200, 60, 170),
+    sf::Color(230, 140, 20), sf::Color(30, 180, 180), sf::Color(150, 90, 220), sf::Color(200, 200, 200)
 };
 
+// PNG frames for --record <directory>, on the encoder thread
+bool writePng(const std::string& path, const std::uint8_t* rgba, unsigned width, unsigned height) {
+    return sf::Image(sf::Vector2u(width, height), rgba).saveToFile(path);
+}
+
 class Game {
 private:
     sf::RenderWindow window;
     GameState state;
-    sf::Font font;
     
-    // Audio
-    sf::Music backgroundMusic;
-    sf::SoundBuffer collectBuffer;
-    sf::SoundBuffer missBuffer;
-    sf::SoundBuffer gameOverBuffer;
-    sf::SoundBuffer victoryBuffer;
-    std::unique_ptr<sf::Sound> collectSound;
-    std::unique_ptr<sf::Sound> missSound;
-    std::unique_ptr<sf::Sound> gameOverSound;
-    std::unique_ptr<sf::Sound> victorySound;
+    // Font, music and sound buffers from assets.pak
+    GameAssets assets;
+    const sf::Font& font;
+    
+    // Audio; effect ids are GameSound values
+    sf::Music& backgroundMusic;
+    VoicePool sounds;
+    
+    // Game rules and state
+    Simulation sim;
     
-    // Player
+    // Every game gets its own seed from the session stream, unless one was
+    // fixed on the command line, in which case every game replays it
+    CounterRng seedSource;
+    bool fixedSeed;
+    
+    // Input recording of the current game, or playback of a --replay log
+    ReplayRecorder recorder;
+    std::unique_ptr<ReplayLog> replayLog;
+    std::unique_ptr<ReplayCursor> replayCursor;
+    
+    // One shape drawn once per basket, recoloured per player
     sf::RectangleShape player;
-    float playerX;
+    sf::RectangleShape playerGauge;
+    
+    // Intro animation
+    IntroScene intro;
     
-    // Game stats
-    int score;
-    int desireGauge;
-    float gameTime;
-    float spawnTimer;
-    float introTimer;
-    int introScene;
-    int lastSpeedIncreaseScore;
-    int lastRangeDecreaseScore;
-    float currentAppleSpeed;
-    int currentMinDesire;
-    int currentMaxDesire;
+    // F2 hands player 1's basket to the planner: it searches once per frame
+    // within AUTOPILOT_BUDGET_MS and steers every tick. In a soak run it also
+    // restarts every finished game and logs the result.
+    LookaheadPlanner autopilot;
+    bool autopilotEnabled;
+    float autopilotMs;
+    bool soak;
+    int soakGames;
+    sf::Clock endScreenClock;
+    sf::Text autopilotLabel;
     
-    // Intro animation apples
-    std::vector<Apple> introApples;
+    // All falling apples go out in one draw call
+    AppleBatch appleBatch;
     
-    // Apples
-    std::vector<Apple> apples;
+    // Sparks, dust and mist from catches, misses and intro apples, also one
+    // draw call. The update runs on particleWorkers with --particle-threads,
+    // otherwise on this thread. Cleared when the intro changes scene.
+    ParticleField particles;
+    ParticleBatch particleBatch;
+    CounterRng effectRng;
+    std::unique_ptr<ThreadPool> particleWorkers;
+    int particleScene;
     
     // UI Elements
-    sf::Text titleText;
-    sf::Text scoreText;
-    sf::Text desireText;
-    sf::Text timerText;
-    sf::Text minDesireLabel;
-    sf::Text maxDesireLabel;
-    sf::RectangleShape desireBar;
-    sf::RectangleShape desireBarBg;
-    sf::RectangleShape desireBarBorder;
-    sf::RectangleShape uiPanel;
-    sf::RectangleShape legendPanel;
+    DirtyText scoreText;
+    DirtyText desireText;
+    DirtyText timerText;
+    HudLayer hud;
+    // Score and gauge row along the bottom, one per player when there are several
+    std::vector<DirtyText> playerTexts;
     
     // Notifications
-    float rangeChangeNotificationTimer;
-    std::string rangeChangeMessage;
-    float speedIncreaseNotificationTimer;
-    std::string speedIncreaseMessage;
+    Notification rangeNotification;
+    Notification speedNotification;
+    Notification playerOutNotification;
+    
+    // Front-end timers of the PLAYING session (notification expiry), in
+    // SIM_TICKs; the rules keep their own in the simulation. Cleared with
+    // the session.
+    TimerWheel sessionTimers;
+    TimerId notificationExpiry[NOTIFICATION_COUNT];
+    
+    // Fixed-tick timing: unsimulated time carried to the next frame, and how
+    // far (0..1) rendering sits between the last two ticks
+    float tickAccumulator;
+    float tickInterpolation;
+    
+    // Keyboard movement comes from KeyPressed/KeyReleased events, stamped as
+    // they are pumped and integrated per tick over the stretch of wall clock
+    // the tick stands for, so a tick moves the basket by how long the key was
+    // really down and a tap between frames still counts. Controls are
+    // player * 2 + direction; keysDown counts the keys held on each (a lone
+    // player has two per direction). --input poll keeps the old per-tick
+    // isKeyPressed() reads and frame limiter, as the baseline
+    // --input-latency measures against.
+    bool pollInput;
+    KeyTimeline keyTimelines[MAX_PLAYERS * 2];
+    std::uint8_t keysDown[MAX_PLAYERS * 2];
+    std::chrono::steady_clock::time_point inputEpoch;
+    // Input clock seconds: the last event pump, the frame's first pump, and
+    // the start of the next tick's span
+    double lastPump;
+    double frameStamp;
+    double tickWindow;
+    std::unique_ptr<InputLatency> latency;
+    std::size_t latencyReported;
+    
+    // Frame pacing (see setPacing); F4 switches modes
+    FramePacer pacer;
+    char pacingText[16];
+    
+    // F3 overlay
+    FrameProfiler profiler;
+    
+    // Heap allocations seen by the last frame (only counted with APPLE_GAME_COUNT_ALLOCS)
+    std::size_t frameAllocations;
+    
+    // Everything is drawn to target: the window, or with --record the canvas,
+    // which the window then shows. Recorded frames are read back without
+    // waiting on the GPU and written out by the encoder's thread. An
+    // offscreen export (--headless) never shows the window and steps the game
+    // one video frame per loop, as fast as it renders. Live play can show
+    // frames at any rate, so it records the frame nearest each 1/VIDEO_FPS
+    // of game time; videoDue is the game time the next one is owed.
+    sf::RenderTarget* target;
+    sf::RenderTexture canvas;
+    FrameCapture capture;
+    VideoEncoder video;
+    bool offscreen;
+    int tailFrames;
+    float videoDue;
+    sf::Clock videoClock;
     
     // Pause menu elements
     sf::RectangleShape pauseOverlay;
@@ -142,131 +259,102 @@ private:
     std::string gameOverReason;
 
 public:
-    Game() : window(sf::VideoMode({WIDTH, HEIGHT}), "Balance of Desire"),
-             font(),
-             titleText(font, "", 32),
-             scoreText(font, "", 28),
-             desireText(font, "", 24),
-             timerText(font, "", 28),
-             minDesireLabel(font, "", 18),
-             maxDesireLabel(font, "", 18),
+    Game(std::uint64_t sessionSeed, bool replaySeed, int players, unsigned particleThreads) : window(sf::VideoMode({WIDTH, HEIGHT}), "Balance of Desire"),
+             assets("assets.pak"), font(assets.getFont()), backgroundMusic(assets.getMusic()),
+             sounds({
+                 {&assets.getSound(GameSound::COLLECT), COLLECT_VOICES, 70.f, 0.06f, 0.15f},
+                 {&assets.getSound(GameSound::MISS), MISS_VOICES, 60.f, 0.04f, 0.15f},
+                 {&assets.getSound(GameSound::GAME_OVER), 1, 80.f, 0.f, 0.f},
+                 {&assets.getSound(GameSound::VICTORY), 1, 80.f, 0.f, 0.f},
+             }, sessionSeed),
+             scoreText(font, 28),
+             desireText(font, 24),
+             timerText(font, 28),
+             hud(font),
              pauseTitle(font, "", 48),
              resumeText(font, "", 28),
              restartText(font, "", 28),
              quitText(font, "", 28),
-             state(GameState::INTRO), playerX(WIDTH / 2.0f), 
-             score(0), desireGauge(50), gameTime(0), spawnTimer(0),
-             introTimer(0), introScene(0), hoveredButton(0),
-             lastSpeedIncreaseScore(0), lastRangeDecreaseScore(0),
-             currentAppleSpeed(APPLE_FALL_SPEED), 
-             currentMinDesire(MIN_DESIRE), currentMaxDesire(MAX_DESIRE),
-             rangeChangeNotificationTimer(0), rangeChangeMessage(""),
-             speedIncreaseNotificationTimer(0), speedIncreaseMessage("") {
-        
-        window.setFramerateLimit(60);
-        srand(static_cast<unsigned>(time(0)));
-        
-        // Load font
-        if (!font.openFromFile("/System/Library/Fonts/Helvetica.ttc")) {
-            if (!font.openFromFile("C:/Windows/Fonts/arial.ttf")) {
-                font.openFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
-            }
+             state(GameState::INTRO),
+             sim(BalanceRules(), sessionSeed, players), seedSource(sessionSeed, SEED_STREAM), fixedSeed(replaySeed),
+             intro(sessionSeed),
+             autopilotEnabled(false), autopilotMs(0), soak(false), soakGames(0), autopilotLabel(font, "AUTOPILOT (F2)", 18),
+             particles(PARTICLE_CAPACITY), effectRng(sessionSeed, PARTICLE_STREAM), particleScene(-1),
+             hoveredButton(0),
+             rangeNotification(font, sf::Color(255, 200, 0)),
+             speedNotification(font, sf::Color(255, 100, 100)),
+             playerOutNotification(font, sf::Color(200, 200, 255)),
+             tickAccumulator(0), tickInterpolation(1), pollInput(false), keysDown{},
+             inputEpoch(std::chrono::steady_clock::now()), lastPump(0), frameStamp(0), tickWindow(0),
+             latencyReported(0), profiler(font),
+             frameAllocations(0), target(&window), offscreen(false), tailFrames(0), videoDue(0) {
+        
+        // Presses and releases are edges; auto-repeat would only add presses
+        window.setKeyRepeatEnabled(false);
+        for (KeyTimeline& timeline : keyTimelines) {
+            timeline = KeyTimeline(SIM_TICK);
         }
         
-        // Load background music
-        if (!backgroundMusic.openFromFile("background_music.ogg")) {
-            if (!backgroundMusic.openFromFile("background_music.mp3")) {
-                backgroundMusic.openFromFile("background_music.wav");
-            }
-        }
         backgroundMusic.setLooping(true);
         backgroundMusic.setVolume(50.f);
-        
-        // Load sound buffers
-        if (!collectBuffer.loadFromFile("collect_sound.ogg")) {
-            collectBuffer.loadFromFile("collect_sound.wav");
-        }
-        if (!missBuffer.loadFromFile("miss_sound.ogg")) {
-            missBuffer.loadFromFile("miss_sound.wav");
-        }
-        if (!gameOverBuffer.loadFromFile("gameover_sound.ogg")) {
-            gameOverBuffer.loadFromFile("gameover_sound.wav");
-        }
-        if (!victoryBuffer.loadFromFile("victory_sound.ogg")) {
-            victoryBuffer.loadFromFile("victory_sound.wav");
-        }
-        
-        // Create sounds with buffers
-        collectSound = std::make_unique<sf::Sound>(collectBuffer);
-        collectSound->setVolume(70.f);
-        missSound = std::make_unique<sf::Sound>(missBuffer);
-        missSound->setVolume(60.f);
-        gameOverSound = std::make_unique<sf::Sound>(gameOverBuffer);
-        gameOverSound->setVolume(80.f);
-        victorySound = std::make_unique<sf::Sound>(victoryBuffer);
-        victorySound->setVolume(80.f);
+
         
         // Setup player
-        player.setSize(sf::Vector2f(70.f, 15.f));
+        player.setSize(sf::Vector2f(BASKET_WIDTH, BASKET_HEIGHT));
         player.setFillColor(sf::Color(139, 69, 19));
-        player.setOutlineThickness(2.f);
+        player.setOutlineThickness(BASKET_OUTLINE);
         player.setOutlineColor(sf::Color(101, 50, 15));
-        player.setOrigin(sf::Vector2f(35.f, 7.5f));
-        player.setPosition(sf::Vector2f(playerX, static_cast<float>(HEIGHT) - 80.f));
+        player.setOrigin(sf::Vector2f(BASKET_WIDTH / 2.f, BASKET_HEIGHT / 2.f));
+        player.setPosition(sf::Vector2f(sim.getBasket().x, BASKET_Y));
+        
+        playerGauge.setOrigin(sf::Vector2f(0.f, 2.f));
+        
+        if (particleThreads > 1) {
+            particleWorkers = std::make_unique<ThreadPool>(particleThreads);
+        }
         
         setupUI();
         setupPauseMenu();
+        
+        std::string error;
+        if (!intro.load(assets.getIntroScript(), error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+        }
+    }
+
+    ~Game() {
+        recorder.end(sim);
     }
 
     void setupUI() {
-        uiPanel.setSize(sf::Vector2f(WIDTH, 120.f));
-        uiPanel.setFillColor(sf::Color(20, 20, 30, 230));
-        uiPanel.setPosition(sf::Vector2f(0.f, 0.f));
-        
-        titleText = sf::Text(font, "BALANCE OF DESIRE", 32);
-        titleText.setFillColor(sf::Color(255, 215, 0));
-        titleText.setStyle(sf::Text::Bold);
-        titleText.setPosition(sf::Vector2f(WIDTH / 2.f - 180.f, 10.f));
-        
-        scoreText = sf::Text(font, "Score: 0", 28);
-        scoreText.setFillColor(sf::Color::White);
-        scoreText.setStyle(sf::Text::Bold);
-        scoreText.setPosition(sf::Vector2f(30.f, 55.f));
-        
-        timerText = sf::Text(font, "Time: 180s", 28);
-        timerText.setFillColor(sf::Color(100, 200, 255));
-        timerText.setStyle(sf::Text::Bold);
-        timerText.setPosition(sf::Vector2f(WIDTH - 180.f, 55.f));
-        
-        desireText = sf::Text(font, "Desire Gauge", 24);
-        desireText.setFillColor(sf::Color(255, 255, 200));
-        desireText.setPosition(sf::Vector2f(WIDTH / 2.f - 80.f, 55.f));
-        
-        desireBarBorder.setSize(sf::Vector2f(304.f, 24.f));
-        desireBarBorder.setFillColor(sf::Color::Transparent);
-        desireBarBorder.setOutlineThickness(3.f);
-        desireBarBorder.setOutlineColor(sf::Color(200, 200, 200));
-        desireBarBorder.setPosition(sf::Vector2f(WIDTH / 2.f - 150.f, 85.f));
-        
-        desireBarBg.setSize(sf::Vector2f(300.f, 20.f));
-        desireBarBg.setFillColor(sf::Color(40, 40, 50));
-        desireBarBg.setPosition(sf::Vector2f(WIDTH / 2.f - 148.f, 87.f));
-        
-        desireBar.setSize(sf::Vector2f(300.f, 20.f));
-        desireBar.setFillColor(sf::Color::Green);
-        desireBar.setPosition(sf::Vector2f(WIDTH / 2.f - 148.f, 87.f));
-        
-        minDesireLabel = sf::Text(font, std::to_string(MIN_DESIRE), 18);
-        minDesireLabel.setFillColor(sf::Color(255, 255, 100));
-        minDesireLabel.setStyle(sf::Text::Bold);
-        
-        maxDesireLabel = sf::Text(font, std::to_string(MAX_DESIRE), 18);
-        maxDesireLabel.setFillColor(sf::Color(255, 255, 100));
-        maxDesireLabel.setStyle(sf::Text::Bold);
-        
-        legendPanel.setSize(sf::Vector2f(WIDTH, 60.f));
-        legendPanel.setFillColor(sf::Color(20, 20, 30, 230));
-        legendPanel.setPosition(sf::Vector2f(0.f, HEIGHT - 60.f));
+        scoreText.format("Score: 0");
+        scoreText.get().setFillColor(sf::Color::White);
+        scoreText.get().setStyle(sf::Text::Bold);
+        scoreText.get().setPosition(sf::Vector2f(30.f, 55.f));
+        
+        timerText.format("Time: 180s");
+        timerText.get().setFillColor(sf::Color(100, 200, 255));
+        timerText.get().setStyle(sf::Text::Bold);
+        timerText.get().setPosition(sf::Vector2f(WIDTH - 180.f, 55.f));
+        
+        desireText.format("Desire Gauge");
+        desireText.get().setFillColor(sf::Color(255, 255, 200));
+        desireText.get().setPosition(sf::Vector2f(WIDTH / 2.f - 80.f, 55.f));
+        
+        autopilotLabel.setFillColor(sf::Color(120, 220, 255));
+        autopilotLabel.setPosition(sf::Vector2f(WIDTH - 180.f, 95.f));
+        
+        const int players = sim.getPlayerCount();
+        if (players > 1) {
+            playerTexts.reserve(players);
+            for (int p = 0; p < players; ++p) {
+                playerTexts.emplace_back(font, 18);
+                sf::Text& text = playerTexts.back().get();
+                text.setFillColor(PLAYER_COLORS[p]);
+                text.setStyle(sf::Text::Bold);
+                text.setPosition(sf::Vector2f(10.f + static_cast<float>(WIDTH) * p / players, HEIGHT - 40.f));
+            }
+        }
     }
 
     void setupPauseMenu() {
@@ -322,25 +410,413 @@ public:
         quitText.setPosition(sf::Vector2f(WIDTH / 2.f - quitBounds.size.x / 2.f, HEIGHT / 2.f + 135.f));
     }
 
+    // Plays a recorded game at 1x instead of reading the keyboard
+    void playReplay(std::unique_ptr<ReplayLog> log) {
+        replayLog = std::move(log);
+        state = GameState::PLAYING;
+        resetGame();
+        backgroundMusic.play();
+    }
+
+    // Soak run: the autopilot plays game after game with no one at the keys
+    void startSoak() {
+        soak = true;
+        autopilotEnabled = true;
+        state = GameState::PLAYING;
+        resetGame();
+        backgroundMusic.play();
+    }
+
+    // Frame pacing: vsync, a target rate held by the pacer, or uncapped.
+    // Frames still step the game in SIM_TICKs and draw between the last
+    // two, so any rate plays the same.
+    void setPacing(PacingMode mode, double hz) {
+        pacer.setMode(mode, hz);
+        window.setVerticalSyncEnabled(mode == PacingMode::VSYNC);
+        profiler.setBudget(mode == PacingMode::TARGET ? 1000.f / static_cast<float>(hz) : 1000.f / 60.f);
+    }
+    
+    // F4: 60, 120, 144 and 240 Hz, uncapped, vsync, and round again
+    void cyclePacing() {
+        if (pacer.getMode() == PacingMode::VSYNC) {
+            setPacing(PacingMode::TARGET, PACING_RATES[0]);
+        } else if (pacer.getMode() == PacingMode::UNCAPPED) {
+            setPacing(PacingMode::VSYNC, 0);
+        } else {
+            int next = 0;
+            while (next < PACING_RATE_COUNT && PACING_RATES[next] <= pacer.getTargetHz()) {
+                next++;
+            }
+            if (next < PACING_RATE_COUNT) {
+                setPacing(PacingMode::TARGET, PACING_RATES[next]);
+            } else {
+                setPacing(PacingMode::UNCAPPED, 0);
+            }
+        }
+    }
+    
+    // --input poll: the keyboard is read once a tick and display() sleeps
+    // out the frame, as before event-timed input and the frame pacer
+    void useInputPolling() {
+        pollInput = true;
+        window.setFramerateLimit(60);
+    }
+    
+    void measureLatency() {
+        latency = std::make_unique<InputLatency>();
+    }
+    
+    // Records every frame from now on to a .y4m or .rgba file, or to a
+    // directory of PNGs. An offscreen export also hides and mutes the game.
+    bool startVideo(const std::string& path, bool offscreenExport) {
+        std::string error;
+        if (!canvas.resize(sf::Vector2u(WIDTH, HEIGHT))) {
+            std::fprintf(stderr, "cannot create the recording canvas\n");
+            return false;
+        }
+        if (!video.open(path, WIDTH, HEIGHT, VIDEO_FPS, error, writePng)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return false;
+        }
+        capture.init(canvas);
+        if (!capture.isAsync()) {
+            std::fprintf(stderr, "no pixel buffer objects, recording reads frames back synchronously\n");
+        }
+        target = &canvas;
+        offscreen = offscreenExport;
+        videoClock.restart();
+        videoDue = 0;
+        if (offscreen) {
+            window.setVisible(false);
+            window.setFramerateLimit(0);
+            sf::Listener::setGlobalVolume(0.f);
+        }
+        return true;
+    }
+
     void run() {
         sf::Clock clock;
         
         while (window.isOpen()) {
-            float deltaTime = clock.restart().asSeconds();
+            if (!pollInput && !offscreen) {
+                pacer.wait();
+            }
+            float frameTime = offscreen ? 1.f / VIDEO_FPS : std::min(clock.restart().asSeconds(), MAX_FRAME_TIME);
+            std::size_t allocationsBefore = allocationCount();
+            profiler.beginFrame();
             
+            profiler.beginPhase(FramePhase::EVENTS);
             handleEvents();
-            update(deltaTime);
+            frameStamp = lastPump;
+            profiler.endPhase();
+            
+            if (soak && !offscreen && (state == GameState::GAME_OVER || state == GameState::VICTORY) &&
+                endScreenClock.getElapsedTime().asSeconds() >= SOAK_RESTART_SECONDS) {
+                state = GameState::PLAYING;
+                resetGame();
+                backgroundMusic.play();
+            }
+            
+            // The rules only ever see SIM_TICK steps, whatever the display rate.
+            // Paused and end screens keep the accumulator so the frozen frame stays put.
+            if (state == GameState::INTRO || state == GameState::PLAYING) {
+                profiler.beginPhase(FramePhase::UPDATE);
+                if (state == GameState::PLAYING && autopilotEnabled) {
+                    auto planStart = LookaheadPlanner::Clock::now();
+                    autopilot.plan(sim, planStart + std::chrono::microseconds(
+                        static_cast<long long>(AUTOPILOT_BUDGET_MS * 1000.f)));
+                    autopilotMs = std::chrono::duration<float, std::milli>(
+                        LookaheadPlanner::Clock::now() - planStart).count();
+                }
+                // The ticks about to run stand for the wall clock up to this
+                // frame's pump, less what stays in the accumulator
+                tickAccumulator += frameTime;
+                tickWindow = frameStamp - tickAccumulator;
+                while (tickAccumulator >= SIM_TICK) {
+                    update(SIM_TICK);
+                    tickAccumulator -= SIM_TICK;
+                }
+                tickInterpolation = tickAccumulator / SIM_TICK;
+                profiler.endPhase();
+            }
+            if (latency) {
+                if (state == GameState::PLAYING) {
+                    latency->settle(pollInput ? frameStamp : tickWindow);
+                } else {
+                    latency->clear();
+                }
+            }
+            
+            profiler.beginPhase(FramePhase::RENDER);
             render();
+            if (video.isOpen()) {
+                captureFrame(frameTime);
+            }
+            profiler.endPhase();
+            
+            profiler.beginPhase(FramePhase::OVERLAY);
+            profiler.setAppleCount(state == GameState::INTRO ? intro.getApples().size() : sim.getApples().size());
+            profiler.setParticleCount(particles.size());
+            if (!pollInput) {
+                profiler.setPacing(pacingLabel(), pacer.getStats());
+            }
+            PlannerStats plannerStats = autopilot.getStats();
+            profiler.setPlannerStats(autopilotEnabled, plannerStats.depth, plannerStats.apples, plannerStats.nodes,
+                                     autopilotMs);
+            if (profiler.isVisible()) {
+                VoiceStats voices = sounds.getStats();
+                profiler.setVoiceStats(voices.active, voices.capacity, voices.peak, voices.steals);
+            }
+            if (!offscreen) {
+                profiler.draw(window);
+            }
+            profiler.endPhase();
+            
+            profiler.beginPhase(FramePhase::DISPLAY);
+            if (!offscreen) {
+                window.display();
+                shownFrame();
+            }
+            profiler.endPhase();
+            profiler.endFrame();
+            
+            if (offscreen && (state == GameState::GAME_OVER || state == GameState::VICTORY) &&
+                ++tailFrames >= static_cast<int>(VIDEO_TAIL_SECONDS * VIDEO_FPS)) {
+                window.close();
+            }
+            
+            frameAllocations = allocationCount() - allocationsBefore;
+            if (frameAllocations > 0 && allocationCountingEnabled() && state == GameState::PLAYING) {
+                std::fprintf(stderr, "frame allocated %zu times\n", frameAllocations);
+            }
+        }
+        
+        if (video.isOpen()) {
+            finishVideo();
+        }
+        if (latency) {
+            printLatency();
+        }
+        if (!pollInput && !offscreen) {
+            PacingStats pacing = pacer.getStats();
+            std::printf("pacing %s: %.1f fps, frame %.2f ms sd %.2f, error mean %.2f max %.2f ms, %llu late\n",
+                        pacingLabel(), pacing.fps, pacing.intervalMeanMs, pacing.intervalStdDevMs,
+                        pacing.errorMeanMs, pacing.errorMaxMs, static_cast<unsigned long long>(pacing.late));
+        }
+    }
+    
+    const char* pacingLabel() {
+        switch (pacer.getMode()) {
+            case PacingMode::VSYNC:
+                return "vsync";
+            case PacingMode::UNCAPPED:
+                return "uncapped";
+            default:
+                std::snprintf(pacingText, sizeof(pacingText), "%.0f Hz", pacer.getTargetHz());
+                return pacingText;
+        }
+    }
+    
+    double inputNow() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - inputEpoch).count();
+    }
+    
+    // After display(): paces the next frame and times the presses this one
+    // showed. The pacer does its waiting before the events are read rather
+    // than after drawing, as a frame limiter would, so a key pressed during
+    // the wait is on screen one frame's work after it was read instead of a
+    // frame period or more.
+    void shownFrame() {
+        if (!pollInput) {
+            pacer.shown();
+        }
+        if (latency) {
+            latency->displayed(inputNow());
+            if (latency->getSampleCount() >= latencyReported + LATENCY_REPORT_EVERY) {
+                printLatency();
+            }
+        }
+    }
+    
+    void printLatency() {
+        LatencyReport report = latency->report();
+        latencyReported = report.samples;
+        std::printf("input latency (%s): %zu presses, mean %.1f ms, p50 %.1f, p95 %.1f, max %.1f; %zu taps lost\n",
+                    pollInput ? "poll" : "events", report.samples, report.meanMs, report.p50Ms, report.p95Ms,
+                    report.maxMs, report.lostTaps);
+        std::fflush(stdout);
+    }
+    
+    // Movement control for a key, or -1
+    int movementControl(sf::Keyboard::Key key) const {
+        const int players = sim.getPlayerCount();
+        if (players == 1) {
+            if (key == sf::Keyboard::Key::Left || key == sf::Keyboard::Key::A) {
+                return 0;
+            }
+            return key == sf::Keyboard::Key::Right || key == sf::Keyboard::Key::D ? 1 : -1;
+        }
+        for (int p = 0; p < players; ++p) {
+            if (key == PLAYER_KEYS[p].left) {
+                return p * 2;
+            }
+            if (key == PLAYER_KEYS[p].right) {
+                return p * 2 + 1;
+            }
+        }
+        return -1;
+    }
+    
+    void keyEdge(sf::Keyboard::Key key, bool pressed, double stamp) {
+        const int control = movementControl(key);
+        if (control < 0) {
+            return;
+        }
+        if (pressed) {
+            if (keysDown[control]++ > 0) {
+                return;
+            }
+            keyTimelines[control].press(stamp);
+            // Only presses that are meant to move a basket are timed
+            if (latency && state == GameState::PLAYING && !replayLog && !(autopilotEnabled && control < 2)) {
+                latency->press(control, stamp);
+            }
+        } else if (keysDown[control] > 0 && --keysDown[control] == 0) {
+            keyTimelines[control].release(stamp);
+            if (latency) {
+                latency->release(control);
+            }
+        }
+    }
+    
+    // Keys let go while the window was not looking never send a release
+    void releaseAllKeys(double stamp) {
+        for (int control = 0; control < MAX_PLAYERS * 2; ++control) {
+            if (keysDown[control] > 0) {
+                keysDown[control] = 0;
+                keyTimelines[control].release(stamp);
+                if (latency) {
+                    latency->release(control);
+                }
+            }
+        }
+    }
+    
+    // A tick's input for one player from the keyboard
+    SimInput keyboardInput(int p, double from, double to) {
+        SimInput input;
+        if (pollInput) {
+            const bool lone = sim.getPlayerCount() == 1;
+            input.left = sf::Keyboard::isKeyPressed(PLAYER_KEYS[p].left) ||
+                         (lone && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A));
+            input.right = sf::Keyboard::isKeyPressed(PLAYER_KEYS[p].right) ||
+                          (lone && sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D));
+        } else {
+            input.leftHeld = keyTimelines[p * 2].held(from, to);
+            input.rightHeld = keyTimelines[p * 2 + 1].held(from, to);
+            input.left = input.leftHeld > 0;
+            input.right = input.rightHeld > 0;
+        }
+        if (latency) {
+            // A poll sees every press pumped so far
+            const double until = pollInput ? frameStamp : to;
+            if (input.left) {
+                latency->seen(p * 2, until);
+            }
+            if (input.right) {
+                latency->seen(p * 2 + 1, until);
+            }
+        }
+        return input;
+    }
+    
+    // Finishes the canvas and, when a video frame is due, queues its
+    // readback; the read from CAPTURE_DEPTH - 1 reads ago has landed by now
+    // and goes to the encoder. A frame is due once half a video frame of
+    // game time has built up, so 60 Hz play records every frame and faster
+    // rates every second or third, keeping the video at VIDEO_FPS.
+    void captureFrame(float frameTime) {
+        canvas.display();
+        const float videoFrame = 1.f / VIDEO_FPS;
+        videoDue = std::min(videoDue + frameTime, videoFrame);
+        if (offscreen || videoDue >= videoFrame / 2) {
+            videoDue -= videoFrame;
+            if (capture.pending() == CAPTURE_DEPTH) {
+                deliverFrame(offscreen);
+            }
+            capture.read(canvas);
+        }
+        if (!offscreen) {
+            window.clear(sf::Color::Black);
+            window.draw(sf::Sprite(canvas.getTexture()));
+            profiler.addDrawCalls(1);
+        }
+    }
+    
+    // A live game drops a frame the encoder has no room for rather than miss
+    // its own frame; an export waits, since no one is watching the clock
+    void deliverFrame(bool wait) {
+        std::uint8_t* slot = video.acquire(wait);
+        if (slot) {
+            capture.collect(canvas, slot);
+            video.submit();
+        } else {
+            capture.discard();
+            video.drop();
+        }
+    }
+    
+    void finishVideo() {
+        while (capture.pending() > 0) {
+            deliverFrame(true);
+        }
+        capture.release(canvas);
+        bool written = video.close();
+        VideoStats stats = video.getStats();
+        float seconds = videoClock.getElapsedTime().asSeconds();
+        std::printf("recorded %llu frames, %llu dropped, %zu queued at most; encoder busy %.1fs of %.1fs",
+                    static_cast<unsigned long long>(stats.written), static_cast<unsigned long long>(stats.dropped),
+                    stats.peakQueued, stats.encodeSeconds, seconds);
+        if (offscreen && seconds > 0) {
+            std::printf(", %.1fx real time", stats.written / static_cast<float>(VIDEO_FPS) / seconds);
+        }
+        std::printf("\n");
+        if (!written) {
+            std::fprintf(stderr, "writing the recording failed\n");
         }
     }
 
     void handleEvents() {
+        // Events carry no time of their own; each happened at some point since
+        // the last pump, and the middle of that stretch is the fair guess
+        const double pump = inputNow();
+        const double stamp = (lastPump + pump) / 2;
+        lastPump = pump;
+        
         while (auto event = window.pollEvent()) {
             if (event->is<sf::Event::Closed>()) {
                 window.close();
             }
+            if (event->is<sf::Event::FocusLost>()) {
+                releaseAllKeys(stamp);
+            }
+            if (const auto* keyReleased = event->getIf<sf::Event::KeyReleased>()) {
+                keyEdge(keyReleased->code, false, stamp);
+            }
             
             if (const auto* keyPressed = event->getIf<sf::Event::KeyPressed>()) {
+                keyEdge(keyPressed->code, true, stamp);
+                if (keyPressed->code == sf::Keyboard::Key::F3) {
+                    profiler.toggle();
+                }
+                if (keyPressed->code == sf::Keyboard::Key::F4 && !pollInput && !offscreen) {
+                    cyclePacing();
+                }
+                if (keyPressed->code == sf::Keyboard::Key::F2 && !replayLog) {
+                    autopilotEnabled = !autopilotEnabled;
+                    autopilot.invalidate();
+                }
+                
                 if (state == GameState::INTRO) {
                     if (keyPressed->code == sf::Keyboard::Key::Space) {
                         state = GameState::PLAYING;
@@ -354,19 +830,21 @@ public:
                         state = GameState::PAUSED;
                         hoveredButton = 0;
                         backgroundMusic.pause();
+                        recorder.pause();
                     }
                 }
                 else if (state == GameState::PAUSED) {
                     if (keyPressed->code == sf::Keyboard::Key::Escape) {
                         state = GameState::PLAYING;
                         backgroundMusic.play();
+                        recorder.resume();
                     }
                 }
                 else if (state == GameState::GAME_OVER || state == GameState::VICTORY) {
                     if (keyPressed->code == sf::Keyboard::Key::R) {
                         state = GameState::INTRO;
-                        introScene = 0;
-                        introTimer = 0;
+                        intro.reset();
+                        particles.clear();
                         backgroundMusic.stop();
                     }
                 }
@@ -396,15 +874,17 @@ public:
                         if (resumeButton.getGlobalBounds().contains(mousePos)) {
                             state = GameState::PLAYING;
                             backgroundMusic.play();
+                            recorder.resume();
                         } else if (restartButton.getGlobalBounds().contains(mousePos)) {
                             state = GameState::PLAYING;
                             resetGame();
                             backgroundMusic.play();
                         } else if (quitButton.getGlobalBounds().contains(mousePos)) {
                             state = GameState::INTRO;
-                            introScene = 0;
-                            introTimer = 0;
+                            intro.reset();
+                            particles.clear();
                             backgroundMusic.stop();
+                            recorder.end(sim);
                         }
                     }
                 }
@@ -415,10 +895,13 @@ public:
     void update(float deltaTime) {
         switch(state) {
             case GameState::INTRO:
-                updateIntro(deltaTime);
+                intro.update(deltaTime);
+                emitIntroParticles();
+                particles.update(deltaTime, particleWorkers.get());
                 break;
             case GameState::PLAYING:
                 updatePlaying(deltaTime);
+                particles.update(deltaTime, particleWorkers.get());
                 break;
             case GameState::PAUSED:
                 break;
@@ -428,274 +911,199 @@ public:
         }
     }
 
-    void updateIntro(float deltaTime) {
-        introTimer += deltaTime;
-        
-        for (auto& apple : introApples) {
-            apple.update();
-        }
-        
-        introApples.erase(
-            std::remove_if(introApples.begin(), introApples.end(),
-                [](const Apple& a) { return a.isOffScreen(); }),
-            introApples.end()
-        );
-        
-        float sceneTime = introTimer;
-        float sceneDuration = 7.0f;
-        
-        switch(introScene) {
-            case 0:
-                if (sceneTime > 1.0f && sceneTime < 1.1f && introApples.empty()) {
-                    introApples.emplace_back(WIDTH / 2.f, -30.f, AppleType::RED);
-                    introApples.back().speed = 2.0f;
-                }
-                if (sceneTime > sceneDuration) {
-                    introTimer = 0;
-                    introScene++;
-                    introApples.clear();
-                }
-                break;
-                
-            case 1:
-                if (sceneTime > 1.5f && sceneTime < 1.6f && introApples.empty()) {
-                    introApples.emplace_back(WIDTH / 2.f, -30.f, AppleType::GOLDEN);
-                    introApples.back().speed = 1.0f;
-                }
-                if (sceneTime > sceneDuration) {
-                    introTimer = 0;
-                    introScene++;
-                    introApples.clear();
-                }
-                break;
-                
-            case 2:
-                if (sceneTime > 1.5f && sceneTime < 1.6f && introApples.empty()) {
-                    introApples.emplace_back(WIDTH / 2.f, -30.f, AppleType::ROTTEN);
-                    introApples.back().speed = 3.0f;
-                }
-                if (sceneTime > sceneDuration) {
-                    introTimer = 0;
-                    introScene++;
-                    introApples.clear();
-                }
-                break;
-                
-            case 3:
-                if (sceneTime > 1.0f && sceneTime < 1.1f && introApples.empty()) {
-                    introApples.emplace_back(WIDTH / 2.f - 100.f, -30.f, AppleType::GOLDEN);
-                    introApples.back().speed = 1.2f;
-                    introApples.emplace_back(WIDTH / 2.f + 100.f, -30.f, AppleType::ROTTEN);
-                    introApples.back().speed = 1.2f;
-                }
-                if (sceneTime > sceneDuration) {
-                    introTimer = 0;
-                    introScene++;
-                    introApples.clear();
-                }
-                break;
-                
-            case 4:
-                if (sceneTime < 5.5f && static_cast<int>(sceneTime * 10) % 3 == 0) {
-                    float randomX = 100.f + static_cast<float>(rand() % (WIDTH - 200));
-                    int appleChoice = rand() % 3;
-                    AppleType type = (appleChoice == 0) ? AppleType::RED : 
-                                   (appleChoice == 1) ? AppleType::GOLDEN : AppleType::ROTTEN;
-                    
-                    if (introApples.size() < 15) {
-                        introApples.emplace_back(randomX, -30.f, type);
-                        introApples.back().speed = 1.5f + static_cast<float>(rand() % 100) / 100.f;
-                    }
-                }
-                if (sceneTime > sceneDuration) {
-                    introTimer = 0;
-                    introScene++;
-                    introApples.clear();
-                }
-                break;
-                
-            case 5:
-                break;
-        }
-    }
-
     void updatePlaying(float deltaTime) {
-        gameTime += deltaTime;
-        
-        if (score >= 200) {
-            int currentMilestone = (score / 200) * 200;
-            if (currentMilestone > lastSpeedIncreaseScore && currentMilestone % 400 == 200) {
-                currentAppleSpeed *= 1.5f;
-                lastSpeedIncreaseScore = currentMilestone;
-                speedIncreaseNotificationTimer = 3.0f;
-                speedIncreaseMessage = "Apples Falling Faster!";
+        SimInput inputs[MAX_PLAYERS];
+        const int players = sim.getPlayerCount();
+        const double from = tickWindow;
+        tickWindow += SIM_TICK;
+        if (replayCursor) {
+            replayCursor->next(inputs[0]);
+        } else if (players == 1) {
+            if (autopilotEnabled) {
+                inputs[0] = autopilot.steer(sim);
+            } else {
+                inputs[0] = keyboardInput(0, from, tickWindow);
             }
-        }
-        
-        if (score >= 400) {
-            int currentMilestone = (score / 200) * 200;
-            if (currentMilestone > lastRangeDecreaseScore && currentMilestone % 400 == 0) {
-                currentMinDesire = std::min(45, currentMinDesire + 5);
-                currentMaxDesire = std::max(55, currentMaxDesire - 5);
-                lastRangeDecreaseScore = currentMilestone;
-                rangeChangeNotificationTimer = 3.0f;
-                rangeChangeMessage = "Safe Zone Narrowed! " + std::to_string(currentMinDesire) + "-" + std::to_string(currentMaxDesire) + "%";
+            recorder.tick(inputs[0]);
+        } else {
+            for (int p = 0; p < players; ++p) {
+                inputs[p] = keyboardInput(p, from, tickWindow);
             }
-        }
-        
-        if (gameTime >= GAME_DURATION) {
-            if (desireGauge >= currentMinDesire && desireGauge <= currentMaxDesire) {
-                state = GameState::VICTORY;
-                backgroundMusic.stop();
-                if (victorySound) victorySound->play();
-            } else {
-                state = GameState::GAME_OVER;
-                gameOverReason = "Time's up!";
-                backgroundMusic.stop();
-                if (gameOverSound) gameOverSound->play();
+            if (autopilotEnabled) {
+                inputs[0] = autopilot.steer(sim);
             }
-            return;
-        }
-        
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Left) || 
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Key::A)) {
-            playerX -= PLAYER_SPEED;
-        }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Key::Right) || 
-            sf::Keyboard::isKeyPressed(sf::Keyboard::Key::D)) {
-            playerX += PLAYER_SPEED;
         }
         
-        playerX = std::max(35.0f, std::min(playerX, static_cast<float>(WIDTH) - 35.0f));
-        player.setPosition(sf::Vector2f(playerX, static_cast<float>(HEIGHT) - 80.f));
+        SimEvents events = sim.step(inputs, deltaTime);
+        const DesireGauge& desire = sim.getDesire();
         
-        spawnTimer += deltaTime;
-        if (spawnTimer > 2.0f) {
-            spawnApple();
-            spawnTimer = 0;
+        for (const AppleResolution& resolution : sim.getResolutions()) {
+            emitResolution(resolution);
         }
         
-        for (auto it = apples.begin(); it != apples.end();) {
-            it->update();
-            
-            if (it->active && it->getBounds().findIntersection(player.getGlobalBounds()).has_value()) {
-                collectApple(*it);
-                it = apples.erase(it);
-            }
-            else if (it->isOffScreen()) {
-                missApple();
-                it = apples.erase(it);
-            }
-            else {
-                ++it;
-            }
+        if (events.speedIncreased) {
+            notify(speedNotification, SPEED_NOTIFICATION_EXPIRY, "Apples Falling Faster!");
+        }
+        if (events.rangeNarrowed) {
+            char message[64];
+            std::snprintf(message, sizeof(message), "Safe Zone Narrowed! %d-%d%%", desire.minSafe, desire.maxSafe);
+            notify(rangeNotification, RANGE_NOTIFICATION_EXPIRY, message);
         }
         
-        static float desireDecayTimer = 0;
-        desireDecayTimer += deltaTime;
-        if (desireDecayTimer > 10.0f) {
-            desireGauge = std::max(0, desireGauge - 1);
-            desireDecayTimer = 0;
+        if (events.eliminated != 0 && !events.finished) {
+            for (int p = 0; p < players; ++p) {
+                if (events.eliminated & (1u << p)) {
+                    char message[64];
+                    std::snprintf(message, sizeof(message), "Player %d is out! %s", p + 1,
+                                  gameOverCauseText(sim.getPlayer(p).cause));
+                    notify(playerOutNotification, PLAYER_OUT_NOTIFICATION_EXPIRY, message);
+                }
+            }
         }
         
-        if (rangeChangeNotificationTimer > 0) {
-            rangeChangeNotificationTimer -= deltaTime;
+        // Every catch and miss gets a voice; more in one tick than an effect
+        // has voices would only steal from the same tick
+        for (int i = 0; i < std::min(events.collectedTotal(), static_cast<int>(COLLECT_VOICES)); ++i) {
+            playSound(GameSound::COLLECT);
         }
-        if (speedIncreaseNotificationTimer > 0) {
-            speedIncreaseNotificationTimer -= deltaTime;
+        for (int i = 0; i < std::min(events.missed, static_cast<int>(MISS_VOICES)); ++i) {
+            playSound(GameSound::MISS);
         }
         
-        if (desireGauge < currentMinDesire) {
-            state = GameState::GAME_OVER;
-            gameOverReason = "Apathy - You lost the will to live";
+        if (events.finished) {
             backgroundMusic.stop();
-            if (gameOverSound) gameOverSound->play();
-        }
-        else if (desireGauge > currentMaxDesire) {
-            state = GameState::GAME_OVER;
-            gameOverReason = "Obsession - Consumed by greed";
-            backgroundMusic.stop();
-            if (gameOverSound) gameOverSound->play();
+            recorder.end(sim);
+            endScreenClock.restart();
+            if (soak) {
+                std::printf("game %d seed %llu: score %d, %s\n", ++soakGames,
+                            static_cast<unsigned long long>(sim.getSeed()), sim.getScore(),
+                            sim.getStatus() == SimStatus::VICTORY ? "victory" : gameOverCauseText(sim.getCause()));
+                std::fflush(stdout);
+            }
+            if (sim.getStatus() == SimStatus::VICTORY) {
+                state = GameState::VICTORY;
+                playSound(GameSound::VICTORY);
+            } else {
+                state = GameState::GAME_OVER;
+                gameOverReason = gameOverCauseText(sim.getCause());
+                playSound(GameSound::GAME_OVER);
+            }
         }
         
-        float desirePercent = desireGauge / 100.0f;
-        desireBar.setSize(sf::Vector2f(300.f * desirePercent, 20.f));
-        
-        if (desireGauge < MIN_DESIRE) {
-            desireBar.setFillColor(sf::Color(200, 50, 50));
-        } else if (desireGauge > MAX_DESIRE) {
-            desireBar.setFillColor(sf::Color(255, 50, 0));
-        } else if (desireGauge < 40) {
-            desireBar.setFillColor(sf::Color(255, 200, 0));
-        } else if (desireGauge > 70) {
-            desireBar.setFillColor(sf::Color(255, 165, 0));
-        } else {
-            desireBar.setFillColor(sf::Color(50, 205, 50));
-        }
+        sessionTimers.advanceTo(sessionTimers.getNow() + 1, [this](std::uint32_t event) {
+            switch (event) {
+                case RANGE_NOTIFICATION_EXPIRY:
+                    rangeNotification.clear();
+                    break;
+                case SPEED_NOTIFICATION_EXPIRY:
+                    speedNotification.clear();
+                    break;
+                case PLAYER_OUT_NOTIFICATION_EXPIRY:
+                    playerOutNotification.clear();
+                    break;
+            }
+        });
     }
-
-    void spawnApple() {
-        float x = static_cast<float>(rand() % (WIDTH - 60) + 30);
-        int chance = rand() % 100;
-        
-        AppleType type;
-        if (chance < 60) {
-            type = AppleType::RED;
-        } else if (chance < 80) {
-            type = AppleType::GOLDEN;
-        } else {
-            type = AppleType::ROTTEN;
+    
+    // Apple positions are their bounding box corner; effects start from the centre
+    void emitResolution(const AppleResolution& resolution) {
+        const float centerX = resolution.x + APPLE_RADIUS;
+        const float centerY = resolution.y + APPLE_RADIUS;
+        if (!resolution.caught) {
+            emitBurst(particles, effectRng, MISS_DUST, centerX, HEIGHT);
+            return;
         }
-        
-        apples.emplace_back(x, -30.f, type);
-        apples.back().speed = currentAppleSpeed;
-    }
-
-    void collectApple(Apple& apple) {
-        if (collectSound) collectSound->play();
-        
-        switch(apple.type) {
-            case AppleType::RED:
-                score += 20;
-                desireGauge = std::min(100, desireGauge + 20);
-                break;
+        switch (resolution.type) {
             case AppleType::GOLDEN:
-                score += 80;
-                desireGauge = std::max(0, desireGauge - 10);
+                emitBurst(particles, effectRng, GOLDEN_SPARKS, centerX, centerY);
                 break;
             case AppleType::ROTTEN:
-                score += 5;
-                desireGauge = std::min(100, desireGauge + 40);
+                emitBurst(particles, effectRng, ROTTEN_MIST, centerX, centerY);
+                break;
+            default: {
+                ParticleBurst sparks = CATCH_SPARKS;
+                sparks.color = appleColor(resolution.type).toInteger();
+                emitBurst(particles, effectRng, sparks, centerX, centerY);
                 break;
+            }
+        }
+    }
+    
+    // Golden apples sparkle and rotten ones trail mist on the way down;
+    // rotten apples burst into mist where they land, the rest kick up dust
+    void emitIntroParticles() {
+        if (intro.getScene() != particleScene) {
+            particleScene = intro.getScene();
+            particles.clear();
+        }
+        const AppleField& introApples = intro.getApples();
+        for (std::size_t i = 0; i < introApples.size(); ++i) {
+            if (introApples.type[i] == AppleType::GOLDEN) {
+                emitBurst(particles, effectRng, GOLDEN_TRAIL, introApples.x[i] + APPLE_RADIUS,
+                          introApples.y[i] + APPLE_RADIUS);
+            } else if (introApples.type[i] == AppleType::ROTTEN) {
+                emitBurst(particles, effectRng, ROTTEN_TRAIL, introApples.x[i] + APPLE_RADIUS,
+                          introApples.y[i] + APPLE_RADIUS);
+            }
+        }
+        for (const AppleLanding& landing : intro.getLanded()) {
+            emitBurst(particles, effectRng, landing.type == AppleType::ROTTEN ? ROTTEN_MIST : MISS_DUST,
+                      landing.x + APPLE_RADIUS, HEIGHT);
         }
     }
+    
+    // Shows the message and (re)arms its expiry on the session wheel
+    void notify(Notification& notification, std::uint32_t expiry, const char* message) {
+        notification.show(message, static_cast<float>(sessionTimers.getNow()) * SIM_TICK, NOTIFICATION_SECONDS);
+        sessionTimers.cancel(notificationExpiry[expiry]);
+        notificationExpiry[expiry] = sessionTimers.schedule(
+            static_cast<std::uint64_t>(NOTIFICATION_SECONDS * SIM_TICK_RATE), expiry);
+    }
+    
+    // Seconds into the session, interpolated between ticks like the rest of the frame
+    float sessionTime() const {
+        return (static_cast<float>(sessionTimers.getNow()) + tickInterpolation) * SIM_TICK;
+    }
 
-    void missApple() {
-        if (missSound) missSound->play();
-        desireGauge = std::max(0, desireGauge - 10);
+    void playSound(GameSound sound) {
+        sounds.play(static_cast<int>(sound));
     }
 
     void resetGame() {
-        score = 0;
-        desireGauge = 50;
-        gameTime = 0;
-        spawnTimer = 0;
-        playerX = WIDTH / 2.0f;
-        apples.clear();
-        introApples.clear();
-        lastSpeedIncreaseScore = 0;
-        lastRangeDecreaseScore = 0;
-        currentAppleSpeed = APPLE_FALL_SPEED;
-        currentMinDesire = MIN_DESIRE;
-        currentMaxDesire = MAX_DESIRE;
-        rangeChangeNotificationTimer = 0;
-        rangeChangeMessage = "";
-        speedIncreaseNotificationTimer = 0;
-        speedIncreaseMessage = "";
+        if (replayLog) {
+            sim.reset(replayLog->getSeed());
+            replayCursor = std::make_unique<ReplayCursor>(*replayLog);
+        } else {
+            recorder.end(sim);
+            sim.reset(fixedSeed ? sim.getSeed() : seedSource.next64());
+            startRecording();
+        }
+        tickAccumulator = 0;
+        intro.reset();
+        particles.clear();
+        autopilot.invalidate();
+        rangeNotification.clear();
+        speedNotification.clear();
+        playerOutNotification.clear();
+        sessionTimers.clear();
+    }
+
+    // replays/seed-<n>.replay; a game with the same seed overwrites it. The
+    // log format holds one player's input, so multiplayer games go unrecorded.
+    void startRecording() {
+        if (sim.getPlayerCount() > 1) {
+            return;
+        }
+        std::error_code error;
+        std::filesystem::create_directories("replays", error);
+        std::string path = "replays/seed-" + std::to_string(sim.getSeed()) + ".replay";
+        if (!recorder.begin(path, sim.getSeed())) {
+            std::fprintf(stderr, "cannot record input to %s\n", path.c_str());
+        }
     }
 
     void render() {
-        window.clear(sf::Color::Black);
+        target->clear(sf::Color::Black);
         
         switch(state) {
             case GameState::INTRO:
@@ -715,17 +1123,23 @@ public:
                 renderVictory();
                 break;
         }
-        
-        window.display();
+    }
+    
+    // Every draw in the frame goes through here so the profiler can count them
+    void draw(const sf::Drawable& drawable) {
+        target->draw(drawable);
+        profiler.addDrawCalls(1);
     }
 
     void renderIntro() {
+        const float introTimer = intro.getTimer();
+        const int introScene = intro.getScene();
+        const AppleField& introApples = intro.getApples();
         float fadeAlpha = 255.f;
-        float sceneDuration = 7.0f;
         float fadeOutStart = 6.0f;
         
-        if (introTimer > fadeOutStart && introScene < 5) {
-            float fadeProgress = (introTimer - fadeOutStart) / (sceneDuration - fadeOutStart);
+        if (introTimer > fadeOutStart && !intro.isHolding()) {
+            float fadeProgress = (introTimer - fadeOutStart) / (intro.getSceneDuration() - fadeOutStart);
             fadeAlpha = 255.f * (1.0f - fadeProgress);
         }
         
@@ -758,31 +1172,23 @@ public:
                 bgGradient.setFillColor(sf::Color(0, 0, 0, 200));
                 break;
         }
-        window.draw(bgGradient);
+        draw(bgGradient);
         
         int appleAlpha = static_cast<int>(fadeAlpha);
-        for (auto& apple : introApples) {
-            sf::CircleShape fadedApple = apple.shape;
-            sf::Color appleColor = fadedApple.getFillColor();
-            appleColor.a = appleAlpha;
-            fadedApple.setFillColor(appleColor);
-            
-            if (apple.type == AppleType::GOLDEN) {
-                sf::CircleShape glow(25.f);
-                glow.setFillColor(sf::Color(255, 215, 0, std::min(50, appleAlpha / 5)));
-                glow.setPosition(apple.shape.getPosition() - sf::Vector2f(10.f, 10.f));
-                window.draw(glow);
-            }
-            
-            if (apple.type == AppleType::ROTTEN) {
-                sf::CircleShape aura(20.f);
-                aura.setFillColor(sf::Color(50, 30, 20, std::min(80, appleAlpha / 3)));
-                aura.setPosition(apple.shape.getPosition() - sf::Vector2f(5.f, 5.f));
-                window.draw(aura);
-            }
+        
+        // Sparkles and mist sit behind the apples that shed them
+        drawParticles();
+        
+        appleBatch.clear();
+        for (std::size_t i = 0; i < introApples.size(); ++i) {
+            sf::Vector2f position(introApples.x[i], introApples.y[i] - introApples.speed[i] * renderLag());
+            AppleType type = introApples.type[i];
             
-            window.draw(fadedApple);
+            sf::Color fadedColor = appleColor(type);
+            fadedColor.a = static_cast<std::uint8_t>(appleAlpha);
+            appleBatch.addCircle(position, APPLE_RADIUS, fadedColor);
         }
+        profiler.addDrawCalls(appleBatch.draw(*target));
         
         float pulseScale = 1.0f + 0.05f * sin(introTimer * 2.0f);
         sf::Text title(font, "BALANCE OF DESIRE", 48);
@@ -792,24 +1198,15 @@ public:
         title.setOrigin(sf::Vector2f(titleBounds.size.x / 2.f, titleBounds.size.y / 2.f));
         title.setPosition(sf::Vector2f(WIDTH / 2.f, 80.f));
         title.setScale(sf::Vector2f(pulseScale, pulseScale));
-        window.draw(title);
-        
-        std::string dialogues[] = {
-            "A single red apple falls from the sky...\n\n\"The apple reflects the desire of mankind.\"",
-            "A golden apple descends slowly...\n\n\"Some desires shine brighter than others...\"\n\"...tempting, precious, yet fleeting.\"",
-            "The light fades. A rotten apple drops...\n\n\"But every desire carries danger within.\"\n\"Corruption follows those who crave too much.\"",
-            "Golden and rotten apples fall together...\n\n\"We must choose...\"\n\"Which desire will we fulfill?\"",
-            "Hundreds of apples fall from the sky...\n\n\"At times, choice is not a gift...\"\n\"...but a necessity.\"",
-            "\"How will you endure your own desire?\"\n\"Find the balance... or be devoured by it.\"\n\n\nPress SPACE to begin\nUse Arrow Keys or A/D to move"
-        };
+        draw(title);
         
         int textAlpha = static_cast<int>(fadeAlpha);
         if (introTimer < 0.8f) {
             textAlpha = static_cast<int>(255.f * (introTimer / 0.8f));
         }
         
-        sf::Text subtitleText(font, dialogues[introScene], 22);
-        sf::Text shadowText(font, dialogues[introScene], 22);
+        sf::Text subtitleText(font, intro.getDialogue(), 22);
+        sf::Text shadowText(font, intro.getDialogue(), 22);
         shadowText.setFillColor(sf::Color(0, 0, 0, std::min(200, textAlpha)));
         shadowText.setLineSpacing(1.4f);
         
@@ -817,7 +1214,7 @@ public:
         subtitleText.setLineSpacing(1.4f);
         sf::FloatRect textBounds = subtitleText.getLocalBounds();
         
-        if (introScene == 5) {
+        if (intro.isHolding()) {
             shadowText.setPosition(sf::Vector2f(WIDTH / 2.f - textBounds.size.x / 2.f + 2.f, HEIGHT / 2.f - textBounds.size.y / 2.f + 2.f));
             subtitleText.setPosition(sf::Vector2f(WIDTH / 2.f - textBounds.size.x / 2.f, HEIGHT / 2.f - textBounds.size.y / 2.f));
         } else {
@@ -825,158 +1222,131 @@ public:
             subtitleText.setPosition(sf::Vector2f(WIDTH / 2.f - textBounds.size.x / 2.f, HEIGHT - 180.f));
         }
         
-        window.draw(shadowText);
-        window.draw(subtitleText);
+        draw(shadowText);
+        draw(subtitleText);
         
-        if (introScene < 5) {
-            sf::Text sceneIndicator(font, "Scene " + std::to_string(introScene + 1) + " / 6", 16);
+        if (!intro.isHolding()) {
+            sf::Text sceneIndicator(font, "Scene " + std::to_string(introScene + 1) + " / " +
+                                          std::to_string(intro.getSceneCount()), 16);
             sceneIndicator.setFillColor(sf::Color(150, 150, 150, std::min(150, static_cast<int>(fadeAlpha * 0.6f))));
             sceneIndicator.setPosition(sf::Vector2f(WIDTH - 120.f, HEIGHT - 25.f));
-            window.draw(sceneIndicator);
+            draw(sceneIndicator);
         }
     }
 
+    void drawParticles() {
+        particleBatch.clear();
+        particleBatch.addParticles(particles, renderLag());
+        profiler.addDrawCalls(particleBatch.draw(*target));
+    }
+
+    // Apples fall in straight lines, so their position at the previous tick is
+    // y - speed * tickScale; this is how many reference frames to pull them back
+    float renderLag() const {
+        return (1.f - tickInterpolation) * SIM_TICK * REFERENCE_FPS;
+    }
+
     void renderPlaying() {
-        for (auto& apple : apples) {
-            window.draw(apple.shape);
+        appleBatch.clear();
+        appleBatch.addApples(sim.getApples(), 255, renderLag());
+        profiler.addDrawCalls(appleBatch.draw(*target));
+        drawParticles();
+        
+        const int players = sim.getPlayerCount();
+        for (int p = 0; p < players; ++p) {
+            const Player& current = sim.getPlayer(p);
+            if (!current.active) {
+                continue;
+            }
+            const Basket& basket = current.basket;
+            float basketX = basket.previousX + (basket.x - basket.previousX) * tickInterpolation;
+            player.setFillColor(PLAYER_COLORS[p]);
+            player.setPosition(sf::Vector2f(basketX, BASKET_Y));
+            draw(player);
+            if (players > 1) {
+                drawPlayerGauge(current.desire, basketX);
+            }
         }
         
-        window.draw(player);
-        window.draw(uiPanel);
-        window.draw(legendPanel);
-        window.draw(titleText);
-        
-        scoreText.setString("Score: " + std::to_string(score));
-        window.draw(scoreText);
+        // The top bar follows player 1; with several players each basket
+        // carries its own gauge and the bottom row lists everyone
+        const DesireGauge& desire = sim.getDesire();
+        hud.update(desire);
+        profiler.addDrawCalls(hud.draw(*target));
         
-        desireText.setString("Desire: " + std::to_string(desireGauge) + "%");
-        window.draw(desireText);
+        if (players == 1) {
+            scoreText.format("Score: %d", sim.getScore());
+            draw(scoreText.get());
+            
+            desireText.format("Desire: %d%%", desire.value);
+            draw(desireText.get());
+        } else {
+            for (int p = 0; p < players; ++p) {
+                const Player& current = sim.getPlayer(p);
+                if (current.active) {
+                    playerTexts[p].format("P%d %s  %d  %d%%", p + 1, PLAYER_KEY_NAMES[p], current.score,
+                                          current.desire.value);
+                } else {
+                    playerTexts[p].format("P%d out  %d", p + 1, current.score);
+                }
+                draw(playerTexts[p].get());
+            }
+        }
         
-        int timeLeft = GAME_DURATION - static_cast<int>(gameTime);
+        int timeLeft = GAME_DURATION - static_cast<int>(sim.getGameTime());
         int minutes = timeLeft / 60;
         int seconds = timeLeft % 60;
-        timerText.setString("Time: " + std::to_string(minutes) + ":" + 
-                           (seconds < 10 ? "0" : "") + std::to_string(seconds));
-        window.draw(timerText);
-        
-        window.draw(desireBarBg);
-        window.draw(desireBar);
-        window.draw(desireBarBorder);
-        
-        float safeStartX = WIDTH / 2.f - 148.f + (currentMinDesire * 3.f);
-        float safeEndX = WIDTH / 2.f - 148.f + (currentMaxDesire * 3.f);
-        
-        sf::RectangleShape safeMarkerLeft(sf::Vector2f(2.f, 26.f));
-        safeMarkerLeft.setFillColor(sf::Color::White);
-        safeMarkerLeft.setPosition(sf::Vector2f(safeStartX, 86.f));
-        window.draw(safeMarkerLeft);
-        
-        sf::RectangleShape safeMarkerRight(sf::Vector2f(2.f, 26.f));
-        safeMarkerRight.setFillColor(sf::Color::White);
-        safeMarkerRight.setPosition(sf::Vector2f(safeEndX, 86.f));
-        window.draw(safeMarkerRight);
-        
-        minDesireLabel.setString(std::to_string(currentMinDesire));
-        maxDesireLabel.setString(std::to_string(currentMaxDesire));
-        
-        sf::FloatRect minBounds = minDesireLabel.getLocalBounds();
-        sf::FloatRect maxBounds = maxDesireLabel.getLocalBounds();
-        
-        minDesireLabel.setPosition(sf::Vector2f(safeStartX - minBounds.size.x - 8.f, 85.f));
-        maxDesireLabel.setPosition(sf::Vector2f(safeEndX + 8.f, 85.f));
-        
-        window.draw(minDesireLabel);
-        window.draw(maxDesireLabel);
-        
-        if (speedIncreaseNotificationTimer > 0) {
-            float alpha = 255.f;
-            if (speedIncreaseNotificationTimer > 2.5f) {
-                alpha = 255.f * (3.0f - speedIncreaseNotificationTimer) / 0.5f;
-            } else if (speedIncreaseNotificationTimer < 0.5f) {
-                alpha = 255.f * (speedIncreaseNotificationTimer / 0.5f);
-            }
-            
-            float yOffset = rangeChangeNotificationTimer > 0 ? -50.f : 0.f;
-            
-            sf::Text notification(font, speedIncreaseMessage, 24);
-            notification.setFillColor(sf::Color(255, 100, 100, static_cast<int>(alpha)));
-            notification.setStyle(sf::Text::Bold);
-            sf::FloatRect notifBounds = notification.getLocalBounds();
-            notification.setPosition(sf::Vector2f(WIDTH / 2.f - notifBounds.size.x / 2.f, HEIGHT / 2.f - 100.f + yOffset));
-            
-            sf::Text notifShadow(font, speedIncreaseMessage, 24);
-            notifShadow.setFillColor(sf::Color(0, 0, 0, static_cast<int>(alpha * 0.8f)));
-            notifShadow.setStyle(sf::Text::Bold);
-            notifShadow.setPosition(sf::Vector2f(WIDTH / 2.f - notifBounds.size.x / 2.f + 2.f, HEIGHT / 2.f - 98.f + yOffset));
-            
-            window.draw(notifShadow);
-            window.draw(notification);
+        timerText.format("Time: %d:%02d", minutes, seconds);
+        draw(timerText.get());
+        if (autopilotEnabled) {
+            draw(autopilotLabel);
         }
         
-        if (rangeChangeNotificationTimer > 0) {
-            float alpha = 255.f;
-            if (rangeChangeNotificationTimer > 2.5f) {
-                alpha = 255.f * (3.0f - rangeChangeNotificationTimer) / 0.5f;
-            } else if (rangeChangeNotificationTimer < 0.5f) {
-                alpha = 255.f * (rangeChangeNotificationTimer / 0.5f);
+        float now = sessionTime();
+        profiler.addDrawCalls(speedNotification.draw(*target, rangeNotification.isActive() ? -50.f : 0.f, now));
+        profiler.addDrawCalls(rangeNotification.draw(*target, 0.f, now));
+        profiler.addDrawCalls(playerOutNotification.draw(*target, 50.f, now));
+    }
+    
+    // Thin bar under a basket: the gauge's fill, red once it leaves the safe range
+    void drawPlayerGauge(const DesireGauge& desire, float basketX) {
+        float left = basketX - BASKET_WIDTH / 2.f;
+        float top = BASKET_Y + BASKET_HEIGHT / 2.f + 8.f;
+        playerGauge.setSize(sf::Vector2f(BASKET_WIDTH, 4.f));
+        playerGauge.setFillColor(sf::Color(60, 60, 60));
+        playerGauge.setPosition(sf::Vector2f(left, top));
+        draw(playerGauge);
+        
+        playerGauge.setSize(sf::Vector2f(BASKET_WIDTH * desire.value / 100.f, 4.f));
+        playerGauge.setFillColor(desire.isSafe() ? sf::Color(100, 220, 100) : sf::Color(230, 60, 60));
+        draw(playerGauge);
+    }
+    
+    // Single player: the score. Several: the winner, the best score among
+    // those still in on a victory, the best overall on a game over.
+    std::string finalScoreLine() const {
+        const int players = sim.getPlayerCount();
+        if (players == 1) {
+            return "Final Score: " + std::to_string(sim.getScore());
+        }
+        bool victory = sim.getStatus() == SimStatus::VICTORY;
+        int winner = -1;
+        for (int p = 0; p < players; ++p) {
+            const Player& candidate = sim.getPlayer(p);
+            if (victory && !candidate.active) {
+                continue;
             }
-            
-            sf::Text notification(font, rangeChangeMessage, 24);
-            notification.setFillColor(sf::Color(255, 200, 0, static_cast<int>(alpha)));
-            notification.setStyle(sf::Text::Bold);
-            sf::FloatRect notifBounds = notification.getLocalBounds();
-            notification.setPosition(sf::Vector2f(WIDTH / 2.f - notifBounds.size.x / 2.f, HEIGHT / 2.f - 100.f));
-            
-            sf::Text notifShadow(font, rangeChangeMessage, 24);
-            notifShadow.setFillColor(sf::Color(0, 0, 0, static_cast<int>(alpha * 0.8f)));
-            notifShadow.setStyle(sf::Text::Bold);
-            notifShadow.setPosition(sf::Vector2f(WIDTH / 2.f - notifBounds.size.x / 2.f + 2.f, HEIGHT / 2.f - 98.f));
-            
-            window.draw(notifShadow);
-            window.draw(notification);
-        }
-        
-        float legendY = HEIGHT - 35.f;
-        float legendStartX = 30.f;
-        float spacing = 235.f;
-        
-        sf::CircleShape redCircle(10.f);
-        redCircle.setFillColor(sf::Color(220, 20, 60));
-        redCircle.setPosition(sf::Vector2f(legendStartX, legendY));
-        window.draw(redCircle);
-        sf::Text redText(font, "Red: +20 score, +20 desire", 16);
-        redText.setFillColor(sf::Color::White);
-        redText.setPosition(sf::Vector2f(legendStartX + 25.f, legendY - 2.f));
-        window.draw(redText);
-        
-        sf::CircleShape goldCircle(10.f);
-        goldCircle.setFillColor(sf::Color(255, 215, 0));
-        goldCircle.setPosition(sf::Vector2f(legendStartX + spacing, legendY));
-        window.draw(goldCircle);
-        sf::Text goldText(font, "Gold: +80 score, -10 desire", 16);
-        goldText.setFillColor(sf::Color::White);
-        goldText.setPosition(sf::Vector2f(legendStartX + spacing + 25.f, legendY - 2.f));
-        window.draw(goldText);
-        
-        sf::CircleShape rottenCircle(10.f);
-        rottenCircle.setFillColor(sf::Color(101, 67, 33));
-        rottenCircle.setPosition(sf::Vector2f(legendStartX + spacing * 2, legendY));
-        window.draw(rottenCircle);
-        sf::Text rottenText(font, "Rotten: +5 score, +40 desire", 16);
-        rottenText.setFillColor(sf::Color::White);
-        rottenText.setPosition(sf::Vector2f(legendStartX + spacing * 2 + 25.f, legendY - 2.f));
-        window.draw(rottenText);
-        
-        sf::Text missedText(font, "Missed: -10 desire", 16);
-        missedText.setFillColor(sf::Color(255, 100, 100));
-        missedText.setPosition(sf::Vector2f(legendStartX + spacing * 3 + 5.f, legendY - 2.f));
-        window.draw(missedText);
+            if (winner < 0 || candidate.score > sim.getPlayer(winner).score) {
+                winner = p;
+            }
+        }
+        return "Player " + std::to_string(winner + 1) + " wins: " + std::to_string(sim.getPlayer(winner).score);
     }
 
     void renderPauseMenu() {
-        window.draw(pauseOverlay);
-        window.draw(pauseMenu);
-        window.draw(pauseTitle);
+        draw(pauseOverlay);
+        draw(pauseMenu);
+        draw(pauseTitle);
         
         if (hoveredButton == 1) {
             resumeButton.setFillColor(sf::Color(255, 60, 100));
@@ -996,101 +1366,251 @@ public:
             quitButton.setFillColor(sf::Color(101, 67, 33));
         }
         
-        window.draw(resumeButton);
-        window.draw(resumeText);
-        window.draw(restartButton);
-        window.draw(restartText);
-        window.draw(quitButton);
-        window.draw(quitText);
+        draw(resumeButton);
+        draw(resumeText);
+        draw(restartButton);
+        draw(restartText);
+        draw(quitButton);
+        draw(quitText);
     }
 
     void renderGameOver() {
         sf::RectangleShape overlay(sf::Vector2f(WIDTH, HEIGHT));
         overlay.setFillColor(sf::Color(0, 0, 0, 200));
-        window.draw(overlay);
+        draw(overlay);
         
         sf::RectangleShape messageBox(sf::Vector2f(600.f, 350.f));
         messageBox.setFillColor(sf::Color(30, 30, 40, 250));
         messageBox.setOutlineThickness(5.f);
         messageBox.setOutlineColor(sf::Color(200, 50, 50));
         messageBox.setPosition(sf::Vector2f(WIDTH / 2.f - 300.f, HEIGHT / 2.f - 175.f));
-        window.draw(messageBox);
+        draw(messageBox);
         
         sf::Text gameOverText(font, "GAME OVER", 48);
         gameOverText.setFillColor(sf::Color(255, 100, 100));
         gameOverText.setStyle(sf::Text::Bold);
         sf::FloatRect bounds = gameOverText.getLocalBounds();
         gameOverText.setPosition(sf::Vector2f(WIDTH / 2.f - bounds.size.x / 2.f, HEIGHT / 2.f - 140.f));
-        window.draw(gameOverText);
+        draw(gameOverText);
         
         sf::Text reasonText(font, gameOverReason, 24);
         reasonText.setFillColor(sf::Color::White);
         sf::FloatRect reasonBounds = reasonText.getLocalBounds();
         reasonText.setPosition(sf::Vector2f(WIDTH / 2.f - reasonBounds.size.x / 2.f, HEIGHT / 2.f - 60.f));
-        window.draw(reasonText);
+        draw(reasonText);
         
-        sf::Text scoreDisplay(font, "Final Score: " + std::to_string(score), 32);
+        sf::Text scoreDisplay(font, finalScoreLine(), 32);
         scoreDisplay.setFillColor(sf::Color(255, 215, 0));
         scoreDisplay.setStyle(sf::Text::Bold);
         sf::FloatRect scoreBounds = scoreDisplay.getLocalBounds();
         scoreDisplay.setPosition(sf::Vector2f(WIDTH / 2.f - scoreBounds.size.x / 2.f, HEIGHT / 2.f + 10.f));
-        window.draw(scoreDisplay);
+        draw(scoreDisplay);
         
         sf::Text restartText(font, "Press R to restart", 22);
         restartText.setFillColor(sf::Color(150, 150, 150));
         sf::FloatRect restartBounds = restartText.getLocalBounds();
         restartText.setPosition(sf::Vector2f(WIDTH / 2.f - restartBounds.size.x / 2.f, HEIGHT / 2.f + 100.f));
-        window.draw(restartText);
+        draw(restartText);
+        
+        drawSeed(HEIGHT / 2.f + 140.f);
     }
 
     void renderVictory() {
         sf::RectangleShape overlay(sf::Vector2f(WIDTH, HEIGHT));
         overlay.setFillColor(sf::Color(0, 0, 0, 200));
-        window.draw(overlay);
+        draw(overlay);
         
         sf::RectangleShape messageBox(sf::Vector2f(600.f, 400.f));
         messageBox.setFillColor(sf::Color(30, 40, 30, 250));
         messageBox.setOutlineThickness(5.f);
         messageBox.setOutlineColor(sf::Color(255, 215, 0));
         messageBox.setPosition(sf::Vector2f(WIDTH / 2.f - 300.f, HEIGHT / 2.f - 200.f));
-        window.draw(messageBox);
+        draw(messageBox);
         
         sf::Text victoryTitle(font, "VICTORY!", 52);
         victoryTitle.setFillColor(sf::Color(255, 215, 0));
         victoryTitle.setStyle(sf::Text::Bold);
         sf::FloatRect titleBounds = victoryTitle.getLocalBounds();
         victoryTitle.setPosition(sf::Vector2f(WIDTH / 2.f - titleBounds.size.x / 2.f, HEIGHT / 2.f - 160.f));
-        window.draw(victoryTitle);
+        draw(victoryTitle);
         
         sf::Text balanceText(font, "You maintained balance!", 28);
         balanceText.setFillColor(sf::Color(100, 255, 100));
         sf::FloatRect balanceBounds = balanceText.getLocalBounds();
         balanceText.setPosition(sf::Vector2f(WIDTH / 2.f - balanceBounds.size.x / 2.f, HEIGHT / 2.f - 80.f));
-        window.draw(balanceText);
+        draw(balanceText);
         
-        sf::Text scoreDisplay(font, "Final Score: " + std::to_string(score), 36);
+        sf::Text scoreDisplay(font, finalScoreLine(), 36);
         scoreDisplay.setFillColor(sf::Color::White);
         scoreDisplay.setStyle(sf::Text::Bold);
         sf::FloatRect scoreBounds = scoreDisplay.getLocalBounds();
         scoreDisplay.setPosition(sf::Vector2f(WIDTH / 2.f - scoreBounds.size.x / 2.f, HEIGHT / 2.f - 10.f));
-        window.draw(scoreDisplay);
-        
-        sf::Text desireDisplay(font, "Final Desire: " + std::to_string(desireGauge) + "%", 28);
-        desireDisplay.setFillColor(sf::Color(150, 255, 150));
-        sf::FloatRect desireBounds = desireDisplay.getLocalBounds();
-        desireDisplay.setPosition(sf::Vector2f(WIDTH / 2.f - desireBounds.size.x / 2.f, HEIGHT / 2.f + 50.f));
-        window.draw(desireDisplay);
+        draw(scoreDisplay);
+        
+        if (sim.getPlayerCount() == 1) {
+            sf::Text desireDisplay(font, "Final Desire: " + std::to_string(sim.getDesire().value) + "%", 28);
+            desireDisplay.setFillColor(sf::Color(150, 255, 150));
+            sf::FloatRect desireBounds = desireDisplay.getLocalBounds();
+            desireDisplay.setPosition(sf::Vector2f(WIDTH / 2.f - desireBounds.size.x / 2.f, HEIGHT / 2.f + 50.f));
+            draw(desireDisplay);
+        }
         
         sf::Text restartText(font, "Press R to restart", 22);
         restartText.setFillColor(sf::Color(150, 150, 150));
         sf::FloatRect restartBounds = restartText.getLocalBounds();
         restartText.setPosition(sf::Vector2f(WIDTH / 2.f - restartBounds.size.x / 2.f, HEIGHT / 2.f + 130.f));
-        window.draw(restartText);
+        draw(restartText);
+        
+        drawSeed(HEIGHT / 2.f + 165.f);
+    }
+    
+    // Replay the same apples with: game --seed <n>
+    void drawSeed(float y) {
+        char seedLine[48];
+        std::snprintf(seedLine, sizeof(seedLine), "Seed: %llu",
+                      static_cast<unsigned long long>(sim.getSeed()));
+        sf::Text seedText(font, seedLine, 16);
+        seedText.setFillColor(sf::Color(120, 120, 120));
+        sf::FloatRect seedBounds = seedText.getLocalBounds();
+        seedText.setPosition(sf::Vector2f(WIDTH / 2.f - seedBounds.size.x / 2.f, y));
+        draw(seedText);
     }
 };
 
-int main() {
-    Game game;
+// Re-simulates a replay headless and reports whether it reproduced the recorded game
+int checkReplay(const ReplayLog& log, int repeat) {
+    ReplayResult result;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < repeat; ++i) {
+        result = simulateReplay(log);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double simulated = static_cast<double>(result.ticks) * SIM_TICK * repeat;
+    
+    std::printf("seed %llu: %llu ticks, %d pauses, score %d, %s\n",
+                static_cast<unsigned long long>(log.getSeed()), static_cast<unsigned long long>(result.ticks),
+                result.pauses, result.score,
+                result.status == SimStatus::RUNNING ? "abandoned" : gameOverCauseText(result.cause));
+    std::printf("%.0fx real time (%.1f ms per replay)\n",
+                seconds > 0 ? simulated / seconds : 0.0, seconds * 1000.0 / repeat);
+    if (result.corrupt) {
+        std::printf("log is truncated or corrupt\n");
+        return 1;
+    }
+    if (!result.hasEnd) {
+        std::printf("log has no end record\n");
+        return 1;
+    }
+    if (!result.matches()) {
+        std::printf("MISMATCH: recorded score %d\n", result.recordedScore);
+        return 1;
+    }
+    std::printf("matches the recorded game\n");
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    // --seed <n> plays that seed's apples every game; otherwise seed from the OS.
+    // --replay <file> plays a recorded game, --headless re-simulates it without
+    // a window (--repeat <n> times, for timing). --players <n> shares the
+    // playfield between 2 to 8 local players. --particle-threads <n> splits
+    // the particle update across n worker threads. --autopilot lets the
+    // planner play game after game, for demos and soak tests. --record <path>
+    // captures every frame to a .y4m or .rgba video or a directory of PNGs;
+    // with --headless and a --replay or --autopilot game it renders offscreen
+    // at a fixed 60 fps, as fast as it can, and stops after that one game.
+    // --input poll reads the keyboard once a tick instead of from timed key
+    // events, and --input-latency reports how long presses take to show.
+    // --pace <hz>|vsync|uncapped picks the frame pacing (60 Hz by default).
+    std::uint64_t seed = (static_cast<std::uint64_t>(std::random_device()()) << 32) ^
+                         static_cast<std::uint64_t>(time(0));
+    bool replaySeed = false;
+    std::string replayPath;
+    bool headless = false;
+    int repeat = 1;
+    int players = 1;
+    unsigned particleThreads = 1;
+    bool autopilot = false;
+    std::string recordPath;
+    bool pollInput = false;
+    bool measureLatency = false;
+    PacingMode pacing = PacingMode::TARGET;
+    double pacingHz = 60;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--seed" && hasValue) {
+            seed = std::strtoull(argv[++i], nullptr, 10);
+            replaySeed = true;
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--repeat" && hasValue) {
+            repeat = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--players" && hasValue) {
+            players = std::max(1, std::min(MAX_PLAYERS, std::atoi(argv[++i])));
+        } else if (arg == "--particle-threads" && hasValue) {
+            particleThreads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--autopilot") {
+            autopilot = true;
+        } else if (arg == "--record" && hasValue) {
+            recordPath = argv[++i];
+        } else if (arg == "--headless") {
+            headless = true;
+        } else if (arg == "--input" && hasValue) {
+            pollInput = std::string(argv[++i]) == "poll";
+        } else if (arg == "--input-latency") {
+            measureLatency = true;
+        } else if (arg == "--pace" && hasValue) {
+            std::string value = argv[++i];
+            if (value == "vsync") {
+                pacing = PacingMode::VSYNC;
+            } else if (value == "uncapped") {
+                pacing = PacingMode::UNCAPPED;
+            } else {
+                pacing = PacingMode::TARGET;
+                pacingHz = std::max(1.0, std::atof(value.c_str()));
+            }
+        }
+    }
+    
+    std::unique_ptr<ReplayLog> log;
+    if (!replayPath.empty()) {
+        log = std::make_unique<ReplayLog>();
+        std::string error;
+        if (!log->open(replayPath, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        if (headless && recordPath.empty()) {
+            return checkReplay(*log, repeat);
+        }
+        seed = log->getSeed();
+        players = 1;
+    }
+    
+    const bool offscreen = headless && !recordPath.empty();
+    if (offscreen && !log && !autopilot) {
+        std::fprintf(stderr, "an offscreen recording needs --replay <file> or --autopilot to play\n");
+        return 1;
+    }
+    
+    Game game(seed, replaySeed, players, particleThreads);
+    if (pollInput) {
+        game.useInputPolling();
+    } else {
+        game.setPacing(pacing, pacingHz);
+    }
+    if (measureLatency) {
+        game.measureLatency();
+    }
+    if (!recordPath.empty() && !game.startVideo(recordPath, offscreen)) {
+        return 1;
+    }
+    if (log) {
+        game.playReplay(std::move(log));
+    } else if (autopilot) {
+        game.startSoak();
+    }
     game.run();
     return 0;
-}
\ No newline at end of file
+}
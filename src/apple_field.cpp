@@ -0,0 +1,210 @@
+#include "apple_field.hpp"
+
+#if !defined(APPLE_FIELD_SCALAR)
+#if defined(__AVX__)
+#include <immintrin.h>
+#define APPLE_FIELD_AVX
+#define APPLE_FIELD_SSE2
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define APPLE_FIELD_SSE2
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define APPLE_FIELD_NEON
+#endif
+#endif
+
+namespace {
+
+const float APPLE_SIZE = APPLE_RADIUS * 2.f;
+const float FLOOR_Y = static_cast<float>(HEIGHT);
+
+#if defined(APPLE_FIELD_SSE2) || defined(APPLE_FIELD_NEON)
+void emitLanes(unsigned hitBits, unsigned missBits, unsigned width, std::size_t base,
+               std::vector<std::uint32_t>& resolved) {
+    unsigned any = hitBits | missBits;
+    for (unsigned lane = 0; any != 0 && lane < width; ++lane) {
+        if ((any >> lane) & 1u) {
+            std::uint32_t kind = (hitBits >> lane) & 1u ? APPLE_CAUGHT : APPLE_MISSED;
+            resolved.push_back(static_cast<std::uint32_t>(base + lane) * 2u + kind);
+        }
+    }
+}
+#endif
+
+}
+
+AppleField::AppleField(std::size_t capacity)
+    : count(0), x(capacity), y(capacity), speed(capacity), type(capacity), active(capacity) {}
+
+bool AppleField::spawn(float px, float py, float fallSpeed, AppleType appleType) {
+    if (full()) {
+        return false;
+    }
+    x[count] = px;
+    y[count] = py;
+    speed[count] = fallSpeed;
+    type[count] = appleType;
+    active[count] = ~0u;
+    ++count;
+    return true;
+}
+
+void AppleField::remove(std::size_t i) {
+    std::size_t last = --count;
+    if (i != last) {
+        x[i] = x[last];
+        y[i] = y[last];
+        speed[i] = speed[last];
+        type[i] = type[last];
+        active[i] = active[last];
+    }
+}
+
+void AppleField::removeResolved(const std::vector<std::uint32_t>& resolved) {
+    // Highest index first: every apple swapped into a hole is then a survivor
+    for (auto it = resolved.rbegin(); it != resolved.rend(); ++it) {
+        remove(resolvedIndex(*it));
+    }
+}
+
+void advanceApplesScalar(AppleField& apples, std::size_t begin, const Box& basket, float stepScale,
+                         std::vector<std::uint32_t>& resolved) {
+    for (std::size_t i = begin; i < apples.size(); ++i) {
+        bool live = apples.active[i] != 0;
+        if (live) {
+            apples.y[i] += apples.speed[i] * stepScale;
+        }
+
+        Box bounds{apples.x[i], apples.y[i], APPLE_SIZE, APPLE_SIZE};
+        if (live && bounds.intersects(basket)) {
+            resolved.push_back(static_cast<std::uint32_t>(i) * 2u + APPLE_CAUGHT);
+        } else if (apples.y[i] > FLOOR_Y) {
+            resolved.push_back(static_cast<std::uint32_t>(i) * 2u + APPLE_MISSED);
+        }
+    }
+}
+
+void advanceApples(AppleField& apples, const Box& basket, float stepScale,
+                   std::vector<std::uint32_t>& resolved) {
+    const std::size_t count = apples.size();
+    float* xs = apples.x.data();
+    float* ys = apples.y.data();
+    const float* speeds = apples.speed.data();
+    const std::uint32_t* masks = apples.active.data();
+    const float right = basket.left + basket.width;
+    const float bottom = basket.top + basket.height;
+    std::size_t i = 0;
+
+#if defined(APPLE_FIELD_AVX)
+    {
+        const __m256 left8 = _mm256_set1_ps(basket.left);
+        const __m256 right8 = _mm256_set1_ps(right);
+        const __m256 top8 = _mm256_set1_ps(basket.top);
+        const __m256 bottom8 = _mm256_set1_ps(bottom);
+        const __m256 size8 = _mm256_set1_ps(APPLE_SIZE);
+        const __m256 floor8 = _mm256_set1_ps(FLOOR_Y);
+        const __m256 scale8 = _mm256_set1_ps(stepScale);
+
+        for (; i + 8 <= count; i += 8) {
+            __m256 live = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(masks + i)));
+            __m256 ax = _mm256_loadu_ps(xs + i);
+            __m256 ay = _mm256_add_ps(_mm256_loadu_ps(ys + i), _mm256_and_ps(_mm256_mul_ps(_mm256_loadu_ps(speeds + i), scale8), live));
+            _mm256_storeu_ps(ys + i, ay);
+
+            __m256 hit = _mm256_and_ps(live, _mm256_cmp_ps(ax, right8, _CMP_LT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(left8, _mm256_add_ps(ax, size8), _CMP_LT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(ay, bottom8, _CMP_LT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(top8, _mm256_add_ps(ay, size8), _CMP_LT_OQ));
+            __m256 miss = _mm256_andnot_ps(hit, _mm256_cmp_ps(ay, floor8, _CMP_GT_OQ));
+
+            unsigned hitBits = static_cast<unsigned>(_mm256_movemask_ps(hit));
+            unsigned missBits = static_cast<unsigned>(_mm256_movemask_ps(miss));
+            if (hitBits | missBits) {
+                emitLanes(hitBits, missBits, 8, i, resolved);
+            }
+        }
+    }
+#endif
+
+#if defined(APPLE_FIELD_SSE2)
+    {
+        const __m128 left4 = _mm_set1_ps(basket.left);
+        const __m128 right4 = _mm_set1_ps(right);
+        const __m128 top4 = _mm_set1_ps(basket.top);
+        const __m128 bottom4 = _mm_set1_ps(bottom);
+        const __m128 size4 = _mm_set1_ps(APPLE_SIZE);
+        const __m128 floor4 = _mm_set1_ps(FLOOR_Y);
+        const __m128 scale4 = _mm_set1_ps(stepScale);
+
+        for (; i + 4 <= count; i += 4) {
+            __m128 live = _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(masks + i)));
+            __m128 ax = _mm_loadu_ps(xs + i);
+            __m128 ay = _mm_add_ps(_mm_loadu_ps(ys + i), _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(speeds + i), scale4), live));
+            _mm_storeu_ps(ys + i, ay);
+
+            __m128 hit = _mm_and_ps(live, _mm_cmplt_ps(ax, right4));
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(left4, _mm_add_ps(ax, size4)));
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(ay, bottom4));
+            hit = _mm_and_ps(hit, _mm_cmplt_ps(top4, _mm_add_ps(ay, size4)));
+            __m128 miss = _mm_andnot_ps(hit, _mm_cmpgt_ps(ay, floor4));
+
+            unsigned hitBits = static_cast<unsigned>(_mm_movemask_ps(hit));
+            unsigned missBits = static_cast<unsigned>(_mm_movemask_ps(miss));
+            if (hitBits | missBits) {
+                emitLanes(hitBits, missBits, 4, i, resolved);
+            }
+        }
+    }
+#elif defined(APPLE_FIELD_NEON)
+    {
+        const float32x4_t left4 = vdupq_n_f32(basket.left);
+        const float32x4_t right4 = vdupq_n_f32(right);
+        const float32x4_t top4 = vdupq_n_f32(basket.top);
+        const float32x4_t bottom4 = vdupq_n_f32(bottom);
+        const float32x4_t size4 = vdupq_n_f32(APPLE_SIZE);
+        const float32x4_t floor4 = vdupq_n_f32(FLOOR_Y);
+        const float32x4_t scale4 = vdupq_n_f32(stepScale);
+
+        for (; i + 4 <= count; i += 4) {
+            uint32x4_t live = vld1q_u32(masks + i);
+            float32x4_t ax = vld1q_f32(xs + i);
+            uint32x4_t step = vandq_u32(vreinterpretq_u32_f32(vmulq_f32(vld1q_f32(speeds + i), scale4)), live);
+            float32x4_t ay = vaddq_f32(vld1q_f32(ys + i), vreinterpretq_f32_u32(step));
+            vst1q_f32(ys + i, ay);
+
+            uint32x4_t hit = vandq_u32(live, vcltq_f32(ax, right4));
+            hit = vandq_u32(hit, vcltq_f32(left4, vaddq_f32(ax, size4)));
+            hit = vandq_u32(hit, vcltq_f32(ay, bottom4));
+            hit = vandq_u32(hit, vcltq_f32(top4, vaddq_f32(ay, size4)));
+            uint32x4_t miss = vbicq_u32(vcgtq_f32(ay, floor4), hit);
+
+            if (vmaxvq_u32(vorrq_u32(hit, miss)) != 0) {
+                std::uint32_t hitLanes[4];
+                std::uint32_t missLanes[4];
+                vst1q_u32(hitLanes, hit);
+                vst1q_u32(missLanes, miss);
+                unsigned hitBits = 0;
+                unsigned missBits = 0;
+                for (unsigned lane = 0; lane < 4; ++lane) {
+                    hitBits |= (hitLanes[lane] & 1u) << lane;
+                    missBits |= (missLanes[lane] & 1u) << lane;
+                }
+                emitLanes(hitBits, missBits, 4, i, resolved);
+            }
+        }
+    }
+#endif
+
+#if !defined(APPLE_FIELD_SSE2) && !defined(APPLE_FIELD_NEON)
+    (void)count;
+    (void)xs;
+    (void)ys;
+    (void)speeds;
+    (void)masks;
+    (void)right;
+    (void)bottom;
+#endif
+
+    advanceApplesScalar(apples, i, basket, stepScale, resolved);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "game_types.hpp"
+
+// Fixed-capacity pool of falling apples stored as parallel arrays, so the
+// per-step update and the basket hit test run as SIMD kernels. Index i across
+// all arrays is one apple; slots [0, size()) are live. Storage is allocated
+// once up front and removal swaps the last apple into the hole, so spawning
+// and despawning never allocate or shift.
+class AppleField {
+private:
+    std::size_t count;
+
+public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> speed;
+    std::vector<AppleType> type;
+    // Lane mask, 0 or ~0u, so the kernels can load it as a float mask directly
+    std::vector<std::uint32_t> active;
+
+    explicit AppleField(std::size_t capacity);
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return x.size(); }
+    bool empty() const { return count == 0; }
+    bool full() const { return count == x.size(); }
+
+    void clear() { count = 0; }
+
+    // Returns false and drops the apple when the pool is full
+    bool spawn(float px, float py, float fallSpeed, AppleType appleType);
+
+    // O(1): moves the last apple into slot i
+    void remove(std::size_t i);
+
+    // Drops the apples listed in resolved (ascending, as produced by advanceApples)
+    void removeResolved(const std::vector<std::uint32_t>& resolved);
+};
+
+const std::size_t APPLE_POOL_CAPACITY = 1024;
+
+// A basket no apple can touch, for fields that only fall (the intro)
+const Box NO_BASKET = Box{0.f, -1.0e9f, 0.f, 0.f};
+
+// Resolution codes packed by advanceApples: index * 2 + kind
+const std::uint32_t APPLE_CAUGHT = 0;
+const std::uint32_t APPLE_MISSED = 1;
+
+inline std::uint32_t resolvedIndex(std::uint32_t code) { return code >> 1; }
+inline std::uint32_t resolvedKind(std::uint32_t code) { return code & 1u; }
+
+// Moves every active apple by speed * stepScale (stepScale is the step length in
+// reference frames), then appends one code per apple that touched the basket
+// (caught) or fell past the bottom edge (missed), in index order. resolved
+// should have capacity for the field so the kernel never allocates.
+void advanceApples(AppleField& apples, const Box& basket, float stepScale,
+                   std::vector<std::uint32_t>& resolved);
+
+// Reference implementation used on targets without SSE2/NEON
+void advanceApplesScalar(AppleField& apples, std::size_t begin, const Box& basket, float stepScale,
+                         std::vector<std::uint32_t>& resolved);
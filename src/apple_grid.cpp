@@ -0,0 +1,275 @@
+#include "apple_grid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const float APPLE_SIZE = APPLE_RADIUS * 2.f;
+
+// Below this many apple/collider pairs a direct test beats the bucketing
+const std::size_t GRID_DIRECT_PAIRS = 64;
+
+}
+
+AppleGrid::AppleGrid(std::size_t capacity, float size)
+    : columns(static_cast<int>(std::ceil(WIDTH / size))),
+      rows(static_cast<int>(std::ceil(HEIGHT / size))),
+      cellSize(size),
+      head(static_cast<std::size_t>(columns * rows), -1),
+      next(capacity, -1), previous(capacity, -1), cellOf(capacity, -1),
+      tracked(0), relinks(0), inverseCellSize(1.f / size),
+      cellCount(head.size(), 0), cellOffset(head.size(), 0) {
+    touchedCells.reserve(head.size());
+}
+
+// Clamped in float first: truncation then equals floor, and far-off
+// coordinates cannot overflow the int conversion
+int AppleGrid::column(float x) const {
+    return static_cast<int>(std::max(0.f, std::min(static_cast<float>(columns - 1), x * inverseCellSize)));
+}
+
+int AppleGrid::row(float y) const {
+    return static_cast<int>(std::max(0.f, std::min(static_cast<float>(rows - 1), y * inverseCellSize)));
+}
+
+void AppleGrid::link(std::size_t i, std::int32_t cell) {
+    std::int32_t first = head[cell];
+    next[i] = first;
+    previous[i] = -1;
+    if (first >= 0) {
+        previous[first] = static_cast<std::int32_t>(i);
+    }
+    head[cell] = static_cast<std::int32_t>(i);
+    cellOf[i] = cell;
+}
+
+void AppleGrid::unlink(std::size_t i) {
+    if (previous[i] >= 0) {
+        next[previous[i]] = next[i];
+    } else {
+        head[cellOf[i]] = next[i];
+    }
+    if (next[i] >= 0) {
+        previous[next[i]] = previous[i];
+    }
+}
+
+void AppleGrid::clear() {
+    std::fill(head.begin(), head.end(), -1);
+    tracked = 0;
+}
+
+void AppleGrid::update(const AppleField& apples) {
+    if (tracked > apples.size()) {
+        // The field was cleared behind our back
+        clear();
+    }
+    for (std::size_t i = 0; i < tracked; ++i) {
+        std::int32_t cell = row(apples.y[i]) * columns + column(apples.x[i]);
+        if (cell != cellOf[i]) {
+            unlink(i);
+            link(i, cell);
+            relinks++;
+        }
+    }
+    for (std::size_t i = tracked; i < apples.size(); ++i) {
+        link(i, row(apples.y[i]) * columns + column(apples.x[i]));
+    }
+    tracked = apples.size();
+}
+
+void AppleGrid::colliderCells(const Box& collider, int& left, int& right, int& top, int& bottom) const {
+    // Apples are filed by their top-left corner, so reach one apple back
+    left = column(collider.left - APPLE_SIZE);
+    right = column(collider.left + collider.width);
+    top = row(collider.top - APPLE_SIZE);
+    bottom = row(collider.top + collider.height);
+}
+
+void AppleGrid::collide(const AppleField& apples, const Box* colliders, std::size_t colliderCount,
+                        std::vector<AppleHit>& hits) {
+    if (apples.size() * colliderCount <= GRID_DIRECT_PAIRS) {
+        // Already in (apple, collider) order
+        for (std::size_t i = 0; i < apples.size(); ++i) {
+            if (!apples.active[i]) {
+                continue;
+            }
+            Box bounds{apples.x[i], apples.y[i], APPLE_SIZE, APPLE_SIZE};
+            for (std::size_t c = 0; c < colliderCount; ++c) {
+                if (bounds.intersects(colliders[c])) {
+                    hits.push_back(AppleHit{static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(c)});
+                }
+            }
+        }
+        return;
+    }
+
+    int left, right, top, bottom;
+
+    // Count colliders per cell, then lay them out cell by cell
+    touchedCells.clear();
+    for (std::size_t c = 0; c < colliderCount; ++c) {
+        colliderCells(colliders[c], left, right, top, bottom);
+        for (int r = top; r <= bottom; ++r) {
+            for (int col = left; col <= right; ++col) {
+                std::int32_t cell = r * columns + col;
+                if (cellCount[cell]++ == 0) {
+                    touchedCells.push_back(cell);
+                }
+            }
+        }
+    }
+    std::uint32_t total = 0;
+    for (std::int32_t cell : touchedCells) {
+        cellOffset[cell] = total;
+        total += cellCount[cell];
+        cellCount[cell] = 0;
+    }
+    if (cellColliders.size() < total) {
+        cellColliders.resize(total);
+    }
+    // Filled in order of left edge, so every cell's span comes out sorted
+    byLeft.resize(colliderCount);
+    for (std::size_t c = 0; c < colliderCount; ++c) {
+        byLeft[c] = static_cast<std::uint32_t>(c);
+    }
+    std::sort(byLeft.begin(), byLeft.end(), [colliders](std::uint32_t a, std::uint32_t b) {
+        return colliders[a].left != colliders[b].left ? colliders[a].left < colliders[b].left : a < b;
+    });
+    for (std::uint32_t c : byLeft) {
+        colliderCells(colliders[c], left, right, top, bottom);
+        for (int r = top; r <= bottom; ++r) {
+            for (int col = left; col <= right; ++col) {
+                std::int32_t cell = r * columns + col;
+                cellColliders[cellOffset[cell] + cellCount[cell]++] = c;
+            }
+        }
+    }
+
+    // With each cell's span sorted, the furthest right edge so far and the
+    // rows the span covers let an apple test only the colliders level with
+    // it that reach its columns
+    if (spanReach.size() < total) {
+        spanReach.resize(total);
+    }
+    const std::size_t firstHit = hits.size();
+    bool ordered = true;
+    std::int64_t lastApple = -1;
+    groups.clear();
+    for (std::int32_t cell : touchedCells) {
+        const std::uint32_t* first = &cellColliders[cellOffset[cell]];
+        const std::uint32_t count = cellCount[cell];
+        cellCount[cell] = 0;
+        float* reach = &spanReach[cellOffset[cell]];
+        float spanTop = colliders[first[0]].top;
+        float spanBottom = spanTop + colliders[first[0]].height;
+        float furthest = colliders[first[0]].left + colliders[first[0]].width;
+        for (std::uint32_t a = 0; a < count; ++a) {
+            const Box& box = colliders[first[a]];
+            furthest = std::max(furthest, box.left + box.width);
+            reach[a] = furthest;
+            spanTop = std::min(spanTop, box.top);
+            spanBottom = std::max(spanBottom, box.top + box.height);
+        }
+
+        for (std::int32_t i = head[cell]; i >= 0; i = next[i]) {
+            if (!apples.active[i] || !(apples.y[i] < spanBottom && spanTop < apples.y[i] + APPLE_SIZE)) {
+                continue;
+            }
+            Box bounds{apples.x[i], apples.y[i], APPLE_SIZE, APPLE_SIZE};
+            // First collider whose span reaches past the apple's left edge
+            std::uint32_t a = static_cast<std::uint32_t>(
+                std::upper_bound(reach, reach + count, bounds.left) - reach);
+            std::size_t groupStart = hits.size();
+            for (; a < count && colliders[first[a]].left < bounds.left + APPLE_SIZE; ++a) {
+                if (bounds.intersects(colliders[first[a]])) {
+                    hits.push_back(AppleHit{static_cast<std::uint32_t>(i), first[a]});
+                }
+            }
+            if (hits.size() == groupStart) {
+                continue;
+            }
+            // Sorted by collider within the apple; colliders an apple
+            // touches are few
+            for (std::size_t h = groupStart + 1; h < hits.size(); ++h) {
+                AppleHit hit = hits[h];
+                std::size_t g = h;
+                for (; g > groupStart && hits[g - 1].collider > hit.collider; --g) {
+                    hits[g] = hits[g - 1];
+                }
+                hits[g] = hit;
+            }
+            ordered = ordered && i > lastApple;
+            lastApple = i;
+            groups.push_back(HitGroup{static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(groupStart),
+                                      static_cast<std::uint32_t>(hits.size() - groupStart)});
+        }
+    }
+
+    // Cells come in collider order, not apple order: put the apples' runs
+    // of hits in order, which moves runs rather than sorting every hit
+    if (!ordered) {
+        std::sort(groups.begin(), groups.end(),
+                  [](const HitGroup& a, const HitGroup& b) { return a.apple < b.apple; });
+        orderedHits.clear();
+        for (const HitGroup& group : groups) {
+            orderedHits.insert(orderedHits.end(), hits.begin() + group.begin, hits.begin() + group.begin + group.count);
+        }
+        std::copy(orderedHits.begin(), orderedHits.end(), hits.begin() + static_cast<std::ptrdiff_t>(firstHit));
+    }
+}
+
+void AppleGrid::remove(AppleField& apples, std::size_t i) {
+    std::size_t last = apples.size() - 1;
+    unlink(i);
+    if (i != last) {
+        // The last apple takes slot i: rewire its list neighbours to the new index
+        std::int32_t slot = static_cast<std::int32_t>(i);
+        next[i] = next[last];
+        previous[i] = previous[last];
+        cellOf[i] = cellOf[last];
+        if (previous[i] >= 0) {
+            next[previous[i]] = slot;
+        } else {
+            head[cellOf[i]] = slot;
+        }
+        if (next[i] >= 0) {
+            previous[next[i]] = slot;
+        }
+    }
+    tracked = last;
+    apples.remove(i);
+}
+
+void AppleGrid::removeResolved(AppleField& apples, const std::vector<std::uint32_t>& resolved) {
+    for (auto it = resolved.rbegin(); it != resolved.rend(); ++it) {
+        remove(apples, resolvedIndex(*it));
+    }
+}
+
+void mergeCatches(const std::vector<AppleHit>& hits, std::vector<std::uint32_t>& resolved,
+                  std::vector<std::uint32_t>& scratch) {
+    if (hits.empty()) {
+        return;
+    }
+    scratch.clear();
+    std::size_t miss = 0;
+    for (std::size_t h = 0; h < hits.size(); ++h) {
+        std::uint32_t apple = hits[h].apple;
+        if (h > 0 && hits[h - 1].apple == apple) {
+            continue;
+        }
+        while (miss < resolved.size() && resolvedIndex(resolved[miss]) < apple) {
+            scratch.push_back(resolved[miss++]);
+        }
+        if (miss < resolved.size() && resolvedIndex(resolved[miss]) == apple) {
+            miss++;
+        }
+        scratch.push_back(apple * 2u + APPLE_CAUGHT);
+    }
+    while (miss < resolved.size()) {
+        scratch.push_back(resolved[miss++]);
+    }
+    resolved.swap(scratch);
+}
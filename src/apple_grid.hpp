@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "apple_field.hpp"
+
+const float GRID_CELL_SIZE = 64.f;
+
+// An apple touching collider `collider` (an index into the caller's list)
+struct AppleHit {
+    std::uint32_t apple;
+    std::uint32_t collider;
+};
+
+// Uniform-grid broadphase over the playfield for an AppleField. Every apple
+// sits in the cell of its top-left corner (apples off the field clamp to the
+// border cells), linked into that cell's list. update() only relinks apples
+// whose cell changed since the last tick, and removals must go through the
+// grid so it can follow AppleField's swap-and-pop. collide() buckets the
+// colliders by cell and walks each covered cell's apples once, however many
+// colliders share it. Within a cell the colliders are kept in order of left
+// edge, so an apple finds the ones reaching its columns by binary search and
+// an apple outside the rows they span is skipped outright; baskets sharing
+// a row of cells then cost the apples in those cells plus the hits, not
+// apples times baskets.
+class AppleGrid {
+private:
+    int columns;
+    int rows;
+    float cellSize;
+    std::vector<std::int32_t> head;
+    // Per apple slot: neighbours in the cell list and the cell it is linked in
+    std::vector<std::int32_t> next;
+    std::vector<std::int32_t> previous;
+    std::vector<std::int32_t> cellOf;
+    std::size_t tracked;
+    std::size_t relinks;
+    float inverseCellSize;
+
+    // One apple's run of hits in collide()'s output
+    struct HitGroup {
+        std::uint32_t apple;
+        std::uint32_t begin;
+        std::uint32_t count;
+    };
+
+    // collide() scratch: colliders bucketed by cell, reset after every call
+    std::vector<std::uint32_t> cellCount;
+    std::vector<std::uint32_t> cellOffset;
+    std::vector<std::int32_t> touchedCells;
+    std::vector<std::uint32_t> cellColliders;
+    std::vector<std::uint32_t> byLeft;
+    // Furthest right edge among a cell's colliders up to each one
+    std::vector<float> spanReach;
+    std::vector<HitGroup> groups;
+    std::vector<AppleHit> orderedHits;
+
+    int column(float x) const;
+    int row(float y) const;
+    void colliderCells(const Box& collider, int& left, int& right, int& top, int& bottom) const;
+    void link(std::size_t i, std::int32_t cell);
+    void unlink(std::size_t i);
+
+public:
+    explicit AppleGrid(std::size_t capacity, float size = GRID_CELL_SIZE);
+
+    void clear();
+
+    // Links apples spawned since the last call and relinks moved ones
+    void update(const AppleField& apples);
+
+    // Appends one hit per (apple, collider) overlap, ordered by apple then
+    // collider. Call after update().
+    void collide(const AppleField& apples, const Box* colliders, std::size_t colliderCount,
+                 std::vector<AppleHit>& hits);
+
+    // AppleField::remove through the grid; call after update()
+    void remove(AppleField& apples, std::size_t i);
+    // AppleField::removeResolved through the grid
+    void removeResolved(AppleField& apples, const std::vector<std::uint32_t>& resolved);
+
+    int getColumns() const { return columns; }
+    int getRows() const { return rows; }
+    // Apples moved to another cell since construction, for benchmarks
+    std::size_t getRelinks() const { return relinks; }
+};
+
+// Folds sorted hits into resolved (misses from advanceApples, in index order)
+// so it lists every resolved apple once, in index order, with a catch winning
+// over a miss. scratch is reused to avoid allocating.
+void mergeCatches(const std::vector<AppleHit>& hits, std::vector<std::uint32_t>& resolved,
+                  std::vector<std::uint32_t>& scratch);
@@ -0,0 +1,173 @@
+#include "asset_pack.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+#include "byte_order.hpp"
+
+namespace {
+
+bool readWhole(const std::string& path, std::vector<std::uint8_t>& out) {
+    std::FILE* in = std::fopen(path.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    std::uint8_t buffer[4096];
+    std::size_t read;
+    while ((read = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+        out.insert(out.end(), buffer, buffer + read);
+    }
+    bool ok = !std::ferror(in);
+    std::fclose(in);
+    return ok;
+}
+
+std::size_t alignUp(std::size_t value) {
+    return (value + ASSET_PACK_ALIGNMENT - 1) / ASSET_PACK_ALIGNMENT * ASSET_PACK_ALIGNMENT;
+}
+
+}
+
+bool AssetPack::open(const std::string& path, std::string& error) {
+    entries.clear();
+    if (!file.open(path, error)) {
+        return false;
+    }
+    const std::uint8_t* data = file.getData();
+    std::size_t size = file.getSize();
+
+    if (size < ASSET_PACK_HEADER_SIZE || std::memcmp(data, ASSET_PACK_MAGIC, 4) != 0) {
+        error = path + " is not an asset pack";
+        file.close();
+        return false;
+    }
+    if (getLittleEndian(data + 4, 2) != ASSET_PACK_VERSION) {
+        error = path + " has an unsupported asset pack version";
+        file.close();
+        return false;
+    }
+    std::size_t count = static_cast<std::size_t>(getLittleEndian(data + 6, 2));
+    std::size_t indexSize = static_cast<std::size_t>(getLittleEndian(data + 8, 4));
+    if (indexSize > size - ASSET_PACK_HEADER_SIZE) {
+        error = path + " is truncated";
+        file.close();
+        return false;
+    }
+
+    const std::uint8_t* position = data + ASSET_PACK_HEADER_SIZE;
+    const std::uint8_t* indexEnd = position + indexSize;
+    entries.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        std::size_t left = static_cast<std::size_t>(indexEnd - position);
+        std::size_t nameLength = left > 0 ? *position : 0;
+        if (left == 0 || left < 1 + nameLength + 16) {
+            error = path + " has a corrupt index";
+            entries.clear();
+            file.close();
+            return false;
+        }
+        AssetEntry entry;
+        entry.name.assign(reinterpret_cast<const char*>(position + 1), nameLength);
+        position += 1 + nameLength;
+        std::uint64_t offset = getLittleEndian(position, 8);
+        std::uint64_t length = getLittleEndian(position + 8, 8);
+        position += 16;
+        if (offset > size || length > size - offset) {
+            error = path + " is truncated";
+            entries.clear();
+            file.close();
+            return false;
+        }
+        entry.data = data + offset;
+        entry.size = static_cast<std::size_t>(length);
+        entries.push_back(std::move(entry));
+    }
+    return true;
+}
+
+const AssetEntry* AssetPack::find(const std::string& name) const {
+    for (const AssetEntry& entry : entries) {
+        if (entry.name == name) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool writeAssetPack(const std::string& path, const std::vector<AssetSource>& sources, std::string& error) {
+    std::vector<std::vector<std::uint8_t>> contents(sources.size());
+    std::size_t indexSize = 0;
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        if (sources[i].name.empty() || sources[i].name.size() > 255) {
+            error = "bad asset name '" + sources[i].name + "'";
+            return false;
+        }
+        if (!readWhole(sources[i].path, contents[i])) {
+            error = "cannot read " + sources[i].path;
+            return false;
+        }
+        indexSize += 1 + sources[i].name.size() + 16;
+    }
+
+    std::vector<std::uint8_t> out;
+    out.insert(out.end(), ASSET_PACK_MAGIC, ASSET_PACK_MAGIC + 4);
+    putLittleEndian(out, ASSET_PACK_VERSION, 2);
+    putLittleEndian(out, sources.size(), 2);
+    putLittleEndian(out, indexSize, 4);
+    putLittleEndian(out, 0, 4);
+
+    std::size_t offset = alignUp(ASSET_PACK_HEADER_SIZE + indexSize);
+    for (std::size_t i = 0; i < sources.size(); ++i) {
+        out.push_back(static_cast<std::uint8_t>(sources[i].name.size()));
+        out.insert(out.end(), sources[i].name.begin(), sources[i].name.end());
+        putLittleEndian(out, offset, 8);
+        putLittleEndian(out, contents[i].size(), 8);
+        offset = alignUp(offset + contents[i].size());
+    }
+    for (const std::vector<std::uint8_t>& content : contents) {
+        out.resize(alignUp(out.size()), 0);
+        out.insert(out.end(), content.begin(), content.end());
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        error = "cannot write " + path;
+        return false;
+    }
+    bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        error = "cannot write " + path;
+    }
+    return written;
+}
+
+const std::vector<AssetCandidates>& gameAssetCandidates() {
+    static const std::vector<AssetCandidates> candidates = {
+        {"font", {"/System/Library/Fonts/Helvetica.ttc", "C:/Windows/Fonts/arial.ttf",
+                  "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf"}},
+        {"music", {"background_music.ogg", "background_music.mp3", "background_music.wav"}},
+        {"collect_sound", {"collect_sound.ogg", "collect_sound.wav"}},
+        {"miss_sound", {"miss_sound.ogg", "miss_sound.wav"}},
+        {"gameover_sound", {"gameover_sound.ogg", "gameover_sound.wav"}},
+        {"victory_sound", {"victory_sound.ogg", "victory_sound.wav"}},
+        {"intro_script", {"intro.script"}},
+        {"apple.png", {"assets/apple.png"}},
+        {"basket.png", {"assets/basket.png"}},
+    };
+    return candidates;
+}
+
+std::vector<AssetSource> resolveGameAssets() {
+    std::vector<AssetSource> sources;
+    for (const AssetCandidates& asset : gameAssetCandidates()) {
+        for (const std::string& path : asset.paths) {
+            if (std::FILE* probe = std::fopen(path.c_str(), "rb")) {
+                std::fclose(probe);
+                sources.push_back(AssetSource{asset.name, path});
+                break;
+            }
+        }
+    }
+    return sources;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+
+// Asset archive. A 16-byte header (magic, version, entry count, index size)
+// is followed by the index, one record per entry:
+//   u8 name length, name bytes, u64 offset, u64 size
+// and then the entry bytes, each starting on a 16-byte boundary. Offsets count
+// from the start of the file, so an entry is a view straight into the mapping.
+const char ASSET_PACK_MAGIC[4] = {'A', 'P', 'A', 'K'};
+const std::uint16_t ASSET_PACK_VERSION = 1;
+const std::size_t ASSET_PACK_HEADER_SIZE = 16;
+const std::size_t ASSET_PACK_ALIGNMENT = 16;
+
+struct AssetEntry {
+    std::string name;
+    const std::uint8_t* data;
+    std::size_t size;
+};
+
+// An archive mapped once; entries point into the mapping and stay valid for
+// the pack's lifetime
+class AssetPack {
+private:
+    MappedFile file;
+    std::vector<AssetEntry> entries;
+
+public:
+    AssetPack() = default;
+
+    // On failure error says why
+    bool open(const std::string& path, std::string& error);
+
+    // nullptr if the pack has no such entry
+    const AssetEntry* find(const std::string& name) const;
+
+    const std::vector<AssetEntry>& getEntries() const { return entries; }
+};
+
+// One file to pack under name
+struct AssetSource {
+    std::string name;
+    std::string path;
+};
+
+// Writes sources to an archive at path; on failure error says why
+bool writeAssetPack(const std::string& path, const std::vector<AssetSource>& sources, std::string& error);
+
+// Where each game asset may live on disk, first existing path wins. The
+// packer resolves these once at build time; without a pack the game does.
+struct AssetCandidates {
+    const char* name;
+    std::vector<std::string> paths;
+};
+
+const std::vector<AssetCandidates>& gameAssetCandidates();
+
+// The first existing path of every candidate that has one
+std::vector<AssetSource> resolveGameAssets();
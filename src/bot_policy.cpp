@@ -0,0 +1,201 @@
+#include "bot_policy.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "lookahead_planner.hpp"
+
+namespace {
+
+SimInput steerTowards(float basketX, float targetX) {
+    SimInput input;
+    if (targetX < basketX - PLAYER_SPEED / 2.f) {
+        input.left = true;
+    } else if (targetX > basketX + PLAYER_SPEED / 2.f) {
+        input.right = true;
+    }
+    return input;
+}
+
+bool canReach(const AppleField& apples, std::size_t i, float basketX) {
+    float distance = std::fabs(apples.x[i] + APPLE_RADIUS - basketX) - CATCH_HALF_WIDTH + 1.f;
+    return distance <= 0.f || distance / PLAYER_SPEED <= stepsUntilCatchHeight(apples, i);
+}
+
+const std::size_t NO_APPLE = static_cast<std::size_t>(-1);
+
+// Holds still
+class IdlePolicy : public BotPolicy {
+public:
+    const char* name() const override { return "idle"; }
+    SimInput decide(const Simulation&) override { return SimInput(); }
+};
+
+// Mashes random directions, holding each choice for a quarter second
+class RandomPolicy : public BotPolicy {
+private:
+    CounterRng rng;
+    SimInput current;
+    int holdSteps = 0;
+
+public:
+    const char* name() const override { return "random"; }
+
+    void reset(std::uint64_t seed) override {
+        rng.reseed(seed, BOT_STREAM);
+        current = SimInput();
+        holdSteps = 0;
+    }
+
+    SimInput decide(const Simulation&) override {
+        if (holdSteps-- <= 0) {
+            int choice = rng.uniformInt(0, 2);
+            current.left = choice == 0;
+            current.right = choice == 1;
+            holdSteps = static_cast<int>(0.25f * SIM_TICK_RATE);
+        }
+        return current;
+    }
+};
+
+// Chases whichever reachable apple lands first, regardless of type
+class GreedyPolicy : public BotPolicy {
+public:
+    const char* name() const override { return "greedy"; }
+
+    SimInput decide(const Simulation& sim) override {
+        const AppleField& apples = sim.getApples();
+        float basketX = sim.getBasket().x;
+        std::size_t target = NO_APPLE;
+        for (std::size_t i = 0; i < apples.size(); ++i) {
+            if (apples.y[i] > CATCH_TOP + BASKET_HEIGHT || !canReach(apples, i, basketX)) {
+                continue;
+            }
+            if (target == NO_APPLE || apples.y[i] > apples.y[target]) {
+                target = i;
+            }
+        }
+        return target != NO_APPLE ? steerTowards(basketX, apples.x[target] + APPLE_RADIUS) : SimInput();
+    }
+};
+
+// Catches an apple only if doing so keeps the gauge safer than missing it,
+// and sidesteps apples it does not want
+class BalancedPolicy : public BotPolicy {
+public:
+    const char* name() const override { return "balanced"; }
+
+    SimInput decide(const Simulation& sim) override {
+        const BalanceRules& rules = sim.getRules();
+        const DesireGauge& desire = sim.getDesire();
+        const AppleField& apples = sim.getApples();
+        float basketX = sim.getBasket().x;
+        float middle = (desire.minSafe + desire.maxSafe) / 2.f;
+
+        auto wanted = [&](std::size_t i) {
+            int caught = desireAfter(desire.value, appleDesireDelta(rules, apples.type[i]));
+            int missed = desireAfter(desire.value, rules.missDesire);
+            bool caughtSafe = caught >= desire.minSafe && caught <= desire.maxSafe;
+            bool missedSafe = missed >= desire.minSafe && missed <= desire.maxSafe;
+            if (!caughtSafe) {
+                return false;
+            }
+            return !missedSafe || std::fabs(caught - middle) <= std::fabs(missed - middle);
+        };
+
+        std::size_t target = NO_APPLE;
+        std::size_t threat = NO_APPLE;
+        for (std::size_t i = 0; i < apples.size(); ++i) {
+            if (apples.y[i] > CATCH_TOP + BASKET_HEIGHT) {
+                continue;
+            }
+            if (wanted(i)) {
+                if (canReach(apples, i, basketX) && (target == NO_APPLE || apples.y[i] > apples.y[target])) {
+                    target = i;
+                }
+            } else if (stepsUntilCatchHeight(apples, i) < 30.f && overlapsBasketColumn(apples, i, basketX)) {
+                if (threat == NO_APPLE || apples.y[i] > apples.y[threat]) {
+                    threat = i;
+                }
+            }
+        }
+
+        if (threat != NO_APPLE) {
+            float threatX = apples.x[threat] + APPLE_RADIUS;
+            bool escapeLeft = threatX > basketX;
+            if (basketX - CATCH_HALF_WIDTH < 35.f) {
+                escapeLeft = false;
+            } else if (basketX + CATCH_HALF_WIDTH > WIDTH - 35.f) {
+                escapeLeft = true;
+            }
+            SimInput input;
+            input.left = escapeLeft;
+            input.right = !escapeLeft;
+            return input;
+        }
+        float targetX = target != NO_APPLE ? apples.x[target] + APPLE_RADIUS : WIDTH / 2.f;
+        return steerTowards(basketX, targetX);
+    }
+};
+
+}
+
+std::unique_ptr<BotPolicy> makeBotPolicy(const std::string& name) {
+    if (name == "idle") {
+        return std::make_unique<IdlePolicy>();
+    }
+    if (name == "random") {
+        return std::make_unique<RandomPolicy>();
+    }
+    if (name == "greedy") {
+        return std::make_unique<GreedyPolicy>();
+    }
+    if (name == "balanced") {
+        return std::make_unique<BalancedPolicy>();
+    }
+    if (name == "planner") {
+        return std::make_unique<LookaheadPlanner>();
+    }
+    return nullptr;
+}
+
+const std::vector<std::string>& botPolicyNames() {
+    static const std::vector<std::string> names = {"idle", "random", "greedy", "balanced", "planner"};
+    return names;
+}
+
+float stepsUntilCatchHeight(const AppleField& apples, std::size_t i) {
+    return std::max(0.f, (CATCH_TOP - apples.y[i]) / apples.speed[i]);
+}
+
+bool overlapsBasketColumn(const AppleField& apples, std::size_t i, float basketX) {
+    return std::fabs(apples.x[i] + APPLE_RADIUS - basketX) < CATCH_HALF_WIDTH;
+}
+
+int desireAfter(int desire, int delta) {
+    return std::max(0, std::min(100, desire + delta));
+}
+
+int appleDesireDelta(const BalanceRules& rules, AppleType type) {
+    switch(type) {
+        case AppleType::RED:
+            return rules.redDesire;
+        case AppleType::GOLDEN:
+            return rules.goldenDesire;
+        case AppleType::ROTTEN:
+            return rules.rottenDesire;
+    }
+    return 0;
+}
+
+int appleScore(const BalanceRules& rules, AppleType type) {
+    switch(type) {
+        case AppleType::RED:
+            return rules.redScore;
+        case AppleType::GOLDEN:
+            return rules.goldenScore;
+        case AppleType::ROTTEN:
+            return rules.rottenScore;
+    }
+    return 0;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "simulation.hpp"
+
+// Apple top at which it starts touching the basket, and the widest distance
+// between apple and basket centres that still touches
+const float CATCH_TOP = BASKET_Y - BASKET_HEIGHT / 2.f - BASKET_OUTLINE - APPLE_RADIUS * 2.f;
+const float CATCH_HALF_WIDTH = BASKET_WIDTH / 2.f + BASKET_OUTLINE + APPLE_RADIUS;
+
+// Decides the basket input for one simulation step. Policies may keep
+// per-game state, so every concurrently running game needs its own instance.
+class BotPolicy {
+public:
+    virtual ~BotPolicy() = default;
+
+    virtual const char* name() const = 0;
+    virtual void reset(std::uint64_t seed) { (void)seed; }
+    virtual SimInput decide(const Simulation& sim) = 0;
+};
+
+// Returns nullptr for unknown names
+std::unique_ptr<BotPolicy> makeBotPolicy(const std::string& name);
+const std::vector<std::string>& botPolicyNames();
+
+// Reference frames until the basket starts overlapping apple i vertically
+float stepsUntilCatchHeight(const AppleField& apples, std::size_t i);
+
+// True if apple i lies within the basket's catch width at basketX
+bool overlapsBasketColumn(const AppleField& apples, std::size_t i, float basketX);
+
+// Desire gauge value after applying a rule delta, clamped like the simulation does
+int desireAfter(int desire, int delta);
+
+int appleDesireDelta(const BalanceRules& rules, AppleType type);
+int appleScore(const BalanceRules& rules, AppleType type);
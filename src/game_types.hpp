@@ -0,0 +1,41 @@
+#pragma once
+
+// Playfield and rule constants shared by the simulation and the SFML front-end
+const int WIDTH = 1000;
+const int HEIGHT = 700;
+const float PLAYER_SPEED = 8.0f;
+const float APPLE_FALL_SPEED = 3.375f;
+const int MIN_DESIRE = 30;
+const int MAX_DESIRE = 80;
+const int GAME_DURATION = 180;
+
+// PLAYER_SPEED and apple speeds are pixels per 60 Hz reference frame; the
+// simulation scales them by elapsed time and runs at a fixed tick rate.
+const float REFERENCE_FPS = 60.f;
+const float SIM_TICK_RATE = 120.f;
+const float SIM_TICK = 1.f / SIM_TICK_RATE;
+
+const float APPLE_RADIUS = 15.0f;
+const float BASKET_WIDTH = 70.f;
+const float BASKET_HEIGHT = 15.f;
+const float BASKET_OUTLINE = 2.f;
+const float BASKET_Y = static_cast<float>(HEIGHT) - 80.f;
+
+enum class AppleType {
+    RED,
+    GOLDEN,
+    ROTTEN
+};
+
+// Axis-aligned box, top-left corner plus size
+struct Box {
+    float left;
+    float top;
+    float width;
+    float height;
+
+    bool intersects(const Box& other) const {
+        return left < other.left + other.width && other.left < left + width &&
+               top < other.top + other.height && other.top < top + height;
+    }
+};
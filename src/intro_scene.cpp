@@ -0,0 +1,217 @@
+#include "intro_scene.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+namespace {
+
+bool parseNumber(const std::string& word, float& value) {
+    char* end = nullptr;
+    value = std::strtof(word.c_str(), &end);
+    return !word.empty() && end == word.c_str() + word.size();
+}
+
+// "3.5" or "100..899"
+bool parseRange(const std::string& word, IntroRange& range) {
+    std::size_t dots = word.find("..");
+    if (dots == std::string::npos) {
+        if (!parseNumber(word, range.low)) {
+            return false;
+        }
+        range.high = range.low;
+        return true;
+    }
+    return parseNumber(word.substr(0, dots), range.low) &&
+           parseNumber(word.substr(dots + 2), range.high) && range.low <= range.high;
+}
+
+bool parseType(const std::string& word, IntroScript::Event& event) {
+    event.anyType = word == "any";
+    if (word == "red" || event.anyType) {
+        event.type = AppleType::RED;
+    } else if (word == "golden") {
+        event.type = AppleType::GOLDEN;
+    } else if (word == "rotten") {
+        event.type = AppleType::ROTTEN;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool compileIntroScript(const std::string& text, IntroScript& script, std::string& error) {
+    IntroScript compiled;
+    float nextStart = 0;
+    int sceneLines = 0;
+    std::istringstream lines(text);
+    std::string line;
+    int lineNumber = 0;
+
+    while (std::getline(lines, line)) {
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        std::istringstream words(line);
+        std::string keyword;
+        if (!(words >> keyword) || keyword[0] == '#') {
+            continue;
+        }
+        auto fail = [&](const char* what) {
+            error = "intro script line " + std::to_string(lineNumber) + ": " + what;
+            return false;
+        };
+
+        if (keyword == "scene") {
+            if (!compiled.scenes.empty() && compiled.scenes.back().duration < 0) {
+                return fail("no scene can follow a held one");
+            }
+            std::string length;
+            words >> length;
+            IntroScript::Scene scene{nextStart, -1.f, ""};
+            if (length != "hold" && (!parseNumber(length, scene.duration) || scene.duration <= 0)) {
+                return fail("scene takes a length in seconds or 'hold'");
+            }
+            nextStart += std::max(0.f, scene.duration);
+            compiled.scenes.push_back(scene);
+            sceneLines = 0;
+
+            IntroScript::Event start{};
+            start.time = scene.start;
+            start.scene = static_cast<int>(compiled.scenes.size()) - 1;
+            compiled.events.push_back(start);
+            continue;
+        }
+        if (compiled.scenes.empty()) {
+            return fail("expected 'scene' first");
+        }
+        IntroScript::Scene& scene = compiled.scenes.back();
+        const int sceneIndex = static_cast<int>(compiled.scenes.size()) - 1;
+        // Spawns must land inside their scene; a held scene has no end
+        auto inScene = [&](float time) {
+            return time >= 0 && (scene.duration < 0 || time < scene.duration);
+        };
+
+        if (keyword == "say") {
+            std::string said;
+            std::getline(words, said);
+            said.erase(0, std::min(said.size(), said.find_first_not_of(' ')));
+            if (sceneLines++ > 0) {
+                scene.dialogue += '\n';
+            }
+            scene.dialogue += said;
+        } else if (keyword == "spawn") {
+            std::string time, type, x, speed;
+            words >> time >> type >> x >> speed;
+            IntroScript::Event event{};
+            event.scene = sceneIndex;
+            event.spawn = true;
+            if (!parseNumber(time, event.time) || !inScene(event.time)) {
+                return fail("spawn time must fall inside the scene");
+            }
+            if (!parseType(type, event) || !parseRange(x, event.x) || !parseRange(speed, event.speed)) {
+                return fail("expected spawn <time> <type> <x> <speed>");
+            }
+            event.time += scene.start;
+            compiled.events.push_back(event);
+        } else if (keyword == "storm") {
+            std::string first, last, count, type, x, speed;
+            words >> first >> last >> count >> type >> x >> speed;
+            IntroScript::Event event{};
+            event.scene = sceneIndex;
+            event.spawn = true;
+            float begin, end, apples;
+            if (!parseNumber(first, begin) || !parseNumber(last, end) || !parseNumber(count, apples) ||
+                !parseType(type, event) || !parseRange(x, event.x) || !parseRange(speed, event.speed)) {
+                return fail("expected storm <start> <end> <count> <type> <x> <speed>");
+            }
+            if (!inScene(begin) || end < begin || (scene.duration >= 0 && end > scene.duration) || apples < 1) {
+                return fail("storm must fall inside the scene and spawn at least one apple");
+            }
+            int total = static_cast<int>(apples);
+            for (int i = 0; i < total; ++i) {
+                event.time = scene.start + begin + (end - begin) * i / total;
+                compiled.events.push_back(event);
+            }
+        } else {
+            return fail("unknown keyword");
+        }
+    }
+
+    if (compiled.scenes.empty()) {
+        error = "intro script has no scenes";
+        return false;
+    }
+    // Stable, so a scene's start stays ahead of spawns at the same moment
+    std::stable_sort(compiled.events.begin(), compiled.events.end(),
+                     [](const IntroScript::Event& a, const IntroScript::Event& b) { return a.time < b.time; });
+    script = std::move(compiled);
+    return true;
+}
+
+IntroScene::IntroScene(std::uint64_t introSeed)
+    : apples(INTRO_APPLE_CAPACITY), seed(introSeed), rng(introSeed, INTRO_STREAM) {
+    resolved.reserve(INTRO_APPLE_CAPACITY);
+    landed.reserve(INTRO_APPLE_CAPACITY);
+    script.scenes.push_back(IntroScript::Scene{0.f, -1.f, "Press SPACE to begin"});
+    reset();
+}
+
+bool IntroScene::load(const std::string& text, std::string& error) {
+    if (!compileIntroScript(text, script, error)) {
+        return false;
+    }
+    reset();
+    return true;
+}
+
+void IntroScene::reset() {
+    rng.reseed(seed, INTRO_STREAM);
+    apples.clear();
+    landed.clear();
+    elapsed = 0;
+    cursor = 0;
+    scene = 0;
+}
+
+float IntroScene::roll(const IntroRange& range) {
+    if (range.high <= range.low) {
+        return range.low;
+    }
+    return range.low + (range.high - range.low) * rng.uniformFloat();
+}
+
+void IntroScene::dispatch(const IntroScript::Event& event) {
+    if (!event.spawn) {
+        scene = event.scene;
+        apples.clear();
+        return;
+    }
+    AppleType type = event.anyType ? static_cast<AppleType>(rng.uniformInt(0, 2)) : event.type;
+    float x = roll(event.x);
+    float speed = roll(event.speed);
+    // Already falling for the part of the step since it was due
+    float late = (elapsed - event.time) * REFERENCE_FPS;
+    apples.spawn(x, -30.f + speed * late, speed, type);
+}
+
+void IntroScene::update(float deltaTime) {
+    elapsed += deltaTime;
+
+    resolved.clear();
+    advanceApples(apples, NO_BASKET, deltaTime * REFERENCE_FPS, resolved);
+    landed.clear();
+    for (std::uint32_t code : resolved) {
+        std::uint32_t index = resolvedIndex(code);
+        landed.push_back(AppleLanding{apples.x[index], apples.type[index]});
+    }
+    apples.removeResolved(resolved);
+
+    const std::vector<IntroScript::Event>& events = script.events;
+    while (cursor < events.size() && events[cursor].time <= elapsed) {
+        dispatch(events[cursor++]);
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "apple_field.hpp"
+#include "random.hpp"
+
+const std::size_t INTRO_APPLE_CAPACITY = 512;
+
+// An intro apple that reached the ground during the last update
+struct AppleLanding {
+    float x;
+    AppleType type;
+};
+
+// A value fixed in the script or a range rolled when the event fires
+struct IntroRange {
+    float low;
+    float high;
+};
+
+struct IntroScript {
+    struct Scene {
+        float start;
+        // Negative for a scene that holds until the player moves on
+        float duration;
+        std::string dialogue;
+    };
+
+    // Sorted by time; a scene's start event comes before its spawns
+    struct Event {
+        float time;
+        int scene;
+        bool spawn;
+        bool anyType;
+        AppleType type;
+        IntroRange x;
+        IntroRange speed;
+    };
+
+    std::vector<Scene> scenes;
+    std::vector<Event> events;
+};
+
+// Compiles the intro script format (see intro.script) into a timeline. On
+// failure error names the line and the script is left untouched.
+bool compileIntroScript(const std::string& text, IntroScript& script, std::string& error);
+
+// The intro's falling-apple choreography, kept free of SFML so it can be
+// stepped headless. A cursor walks the compiled timeline, so each update only
+// touches the events that came due, however long or dense the script, and an
+// apple spawned partway through a step is moved on by the time it missed, so
+// the choreography is the same at any tick rate. The front-end draws the
+// apples and getDialogue(); a held scene waits for the player.
+class IntroScene {
+private:
+    IntroScript script;
+    AppleField apples;
+    std::vector<std::uint32_t> resolved;
+    std::vector<AppleLanding> landed;
+    std::uint64_t seed;
+    CounterRng rng;
+    float elapsed;
+    std::size_t cursor;
+    int scene;
+
+    void dispatch(const IntroScript::Event& event);
+    float roll(const IntroRange& range);
+
+public:
+    // Starts with a single held scene until a script is loaded
+    explicit IntroScene(std::uint64_t introSeed = 0);
+
+    // Compiles and switches to script, then resets; on failure keeps the
+    // current timeline
+    bool load(const std::string& text, std::string& error);
+
+    // Restarts from the first scene with the same apples
+    void reset();
+    void update(float deltaTime);
+
+    const AppleField& getApples() const { return apples; }
+    const std::vector<AppleLanding>& getLanded() const { return landed; }
+    // Seconds into the current scene
+    float getTimer() const { return elapsed - script.scenes[scene].start; }
+    int getScene() const { return scene; }
+    int getSceneCount() const { return static_cast<int>(script.scenes.size()); }
+    float getSceneDuration() const { return script.scenes[scene].duration; }
+    bool isHolding() const { return script.scenes[scene].duration < 0; }
+    const std::string& getDialogue() const { return script.scenes[scene].dialogue; }
+};
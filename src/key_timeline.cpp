@@ -0,0 +1,75 @@
+#include "key_timeline.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "simulation.hpp"
+
+KeyTimeline::KeyTimeline(double minimumHoldSeconds)
+    : times{}, downs{}, head(0), count(0), down(false), lastEdge(-1.0e300), lastPress(-1.0e300),
+      minimumHold(minimumHoldSeconds) {}
+
+bool KeyTimeline::isDownAfterEdges() const {
+    return count > 0 ? downs[(head + count - 1) % KEY_EDGE_CAPACITY] : down;
+}
+
+void KeyTimeline::push(double time, bool pressed) {
+    if (count == KEY_EDGE_CAPACITY) {
+        down = downs[head];
+        head = (head + 1) % KEY_EDGE_CAPACITY;
+        count--;
+    }
+    // Edges stay in order even if the clock they came from did not
+    time = std::max(time, lastEdge);
+    std::size_t slot = (head + count) % KEY_EDGE_CAPACITY;
+    times[slot] = time;
+    downs[slot] = pressed;
+    count++;
+    lastEdge = time;
+}
+
+void KeyTimeline::press(double time) {
+    if (isDownAfterEdges()) {
+        return;
+    }
+    push(time, true);
+    lastPress = lastEdge;
+}
+
+void KeyTimeline::release(double time) {
+    if (!isDownAfterEdges()) {
+        return;
+    }
+    push(std::max(time, lastPress + minimumHold), false);
+}
+
+std::uint8_t KeyTimeline::held(double from, double to) {
+    if (to <= from) {
+        return 0;
+    }
+    double heldTime = 0;
+    double cursor = from;
+    while (count > 0 && times[head] < to) {
+        double edge = std::max(times[head], from);
+        if (down) {
+            heldTime += edge - cursor;
+        }
+        cursor = edge;
+        down = downs[head];
+        head = (head + 1) % KEY_EDGE_CAPACITY;
+        count--;
+    }
+    if (down) {
+        heldTime += to - cursor;
+    }
+    double fraction = std::min(1.0, heldTime / (to - from));
+    return static_cast<std::uint8_t>(std::lround(fraction * INPUT_HOLD_FULL));
+}
+
+void KeyTimeline::clear() {
+    head = 0;
+    count = 0;
+    down = false;
+    lastEdge = -1.0e300;
+    lastPress = -1.0e300;
+}
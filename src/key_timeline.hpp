@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Edges one key keeps between ticks; a burst longer than this has its oldest
+// edges applied at once, untimed
+const std::size_t KEY_EDGE_CAPACITY = 32;
+
+// One held control (a basket direction) as timestamped press and release
+// edges, so a tick can move the basket by exactly how long the key was down
+// during it instead of by whatever a once-per-frame poll happened to see.
+// Times are seconds on the caller's clock. Edges stamped before the span
+// being integrated count from its start, so late events delay movement
+// rather than lose it, and a key released less than minimumHold after it
+// was pressed stays down that long, so a tap between two frames still moves
+// the basket.
+class KeyTimeline {
+private:
+    double times[KEY_EDGE_CAPACITY];
+    bool downs[KEY_EDGE_CAPACITY];
+    std::size_t head;
+    std::size_t count;
+    // State before the oldest queued edge
+    bool down;
+    double lastEdge;
+    double lastPress;
+    double minimumHold;
+
+    void push(double time, bool pressed);
+    bool isDownAfterEdges() const;
+
+public:
+    explicit KeyTimeline(double minimumHoldSeconds = 0);
+
+    void press(double time);
+    void release(double time);
+
+    // Fraction of [from, to) the key was down, in SimInput hold units
+    // (0..INPUT_HOLD_FULL); forgets the edges before `to`
+    std::uint8_t held(double from, double to);
+
+    // Whether the key is down once every queued edge has happened
+    bool isDown() const { return isDownAfterEdges(); }
+    void clear();
+};
@@ -0,0 +1,430 @@
+#include "lookahead_planner.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+// The catch window is narrowed and dodges keep clear by a little, so float
+// drift between plan and simulation does not flip an outcome
+const float CATCH_INSET = 2.f;
+const float DODGE_MARGIN = 4.f;
+const float BASKET_BOTTOM = BASKET_Y + BASKET_HEIGHT / 2.f + BASKET_OUTLINE;
+const float BASKET_MIN_X = 35.f;
+const float BASKET_MAX_X = static_cast<float>(WIDTH) - 35.f;
+// A committed apple matches one in view with its column and type arriving
+// within this many frames of when the plan expected it
+const float MATCH_FRAMES = 2.f;
+
+// Leaf value: score plus SAFETY_WEIGHT times the chance the next apple can be
+// answered safely, plus MARGIN_WEIGHT per point of room to the nearer edge
+const float SAFETY_WEIGHT = 200.f;
+const float MARGIN_WEIGHT = 2.f;
+const float LEAF_BONUS_MAX = SAFETY_WEIGHT + MARGIN_WEIGHT * 50.f;
+// Dead plans rank below every live one, later deaths first
+const float DEATH_VALUE = -1.0e6f;
+
+// Nodes between deadline checks
+const std::size_t CLOCK_INTERVAL = 256;
+
+int clampDesire(int value) {
+    return std::max(0, std::min(100, value));
+}
+
+bool isSafe(int desire, int minSafe, int maxSafe) {
+    return desire >= minSafe && desire <= maxSafe;
+}
+
+}
+
+LookaheadPlanner::LookaheadPlanner(std::size_t nodesPerDecide)
+    : nodeBudget(nodesPerDecide), appleCount(0), eventCount(0), now(0), root(), horizon(0), iterationBest(0),
+      nodes(0), nodeLimit(0), timed(false), aborted(false), planSize(0), planValue(0), signature(0),
+      lastNodes(0) {}
+
+void LookaheadPlanner::reset(std::uint64_t) {
+    invalidate();
+}
+
+void LookaheadPlanner::invalidate() {
+    planSize = 0;
+    planValue = 0;
+    signature = 0;
+}
+
+// Copies the nearest apples and the player's state into the planner's frame,
+// with times in reference frames from now. Returns a signature of the apples
+// in view, which only changes when one spawns or resolves.
+std::uint64_t LookaheadPlanner::observe(const Simulation& sim) {
+    rules = sim.getRules();
+    now = sim.getGameTime() * REFERENCE_FPS;
+
+    const AppleField& field = sim.getApples();
+    std::size_t inView = 0;
+    std::uint64_t hash = field.size();
+    for (std::size_t i = 0; i < field.size(); ++i) {
+        std::uint32_t bits;
+        static_assert(sizeof(bits) == sizeof(float), "float key");
+        std::memcpy(&bits, &field.x[i], sizeof(bits));
+        hash += (static_cast<std::uint64_t>(bits) << 2 | static_cast<std::uint64_t>(field.type[i])) *
+                0x9E3779B97F4A7C15ull;
+        order[inView++] = i;
+    }
+
+    // Landing order decides which apples fit in the horizon
+    auto landsBefore = [&](std::size_t a, std::size_t b) {
+        return (HEIGHT - field.y[a]) / field.speed[a] < (HEIGHT - field.y[b]) / field.speed[b];
+    };
+    std::size_t kept = std::min<std::size_t>(inView, PLANNER_MAX_APPLES);
+    std::partial_sort(order, order + kept, order + inView, landsBefore);
+
+    appleCount = 0;
+    eventCount = 0;
+    for (std::size_t k = 0; k < kept; ++k) {
+        std::size_t i = order[k];
+        float land = (HEIGHT - field.y[i]) / field.speed[i];
+        if (field.y[i] >= BASKET_BOTTOM) {
+            events[eventCount++] = Event{land, EventKind::LAND, FORCED_MISS};
+            continue;
+        }
+        PlanApple& apple = apples[appleCount];
+        apple.x = field.x[i];
+        apple.center = field.x[i] + APPLE_RADIUS;
+        apple.type = field.type[i];
+        apple.arrive = std::max(0.f, (CATCH_TOP - field.y[i]) / field.speed[i]);
+        apple.leave = (BASKET_BOTTOM - field.y[i]) / field.speed[i];
+        apple.land = land;
+        std::uint8_t index = static_cast<std::uint8_t>(appleCount++);
+        events[eventCount++] = Event{apple.arrive, EventKind::ARRIVE, index};
+        events[eventCount++] = Event{apple.leave, EventKind::LEAVE, index};
+        events[eventCount++] = Event{apple.land, EventKind::LAND, index};
+    }
+    // Apples are in landing order, so sorting is stable per apple: arrive, leave, land
+    std::stable_sort(events, events + eventCount, [](const Event& a, const Event& b) { return a.time < b.time; });
+
+    const DesireGauge& desire = sim.getDesire();
+    const float basketX = sim.getBasket().x;
+    const float decayPeriod = rules.decayInterval * REFERENCE_FPS;
+    root.time = 0;
+    root.low = basketX;
+    root.high = basketX;
+    root.desire = desire.value;
+    root.minSafe = desire.minSafe;
+    root.maxSafe = desire.maxSafe;
+    root.score = sim.getScore();
+    root.nextNarrowScore = std::max(rules.milestoneScore * 2,
+                                    sim.getDifficulty().lastRangeDecreaseScore + rules.milestoneScore * 2);
+    root.nextDecay = decayPeriod > 0 ? decayPeriod - std::fmod(now, decayPeriod) : 1.0e9f;
+    return hash;
+}
+
+LookaheadPlanner::Choice LookaheadPlanner::plannedChoice(int apple) const {
+    const PlanApple& candidate = apples[apple];
+    for (int p = 0; p < planSize; ++p) {
+        const PlannedApple& planned = committed[p];
+        if (planned.x == candidate.x && planned.type == candidate.type &&
+            std::fabs(planned.arriveAt - (now + candidate.arrive)) < MATCH_FRAMES) {
+            return planned.choice;
+        }
+    }
+    return UNPLANNED;
+}
+
+// Moves the state forward to `time`: the basket interval widens by what it
+// can travel, and decay ticks on the way. False if decay leaves the safe range.
+bool LookaheadPlanner::advance(PlanState& state, float time) const {
+    float reach = PLAYER_SPEED * (time - state.time);
+    state.low = std::max(BASKET_MIN_X, state.low - reach);
+    state.high = std::min(BASKET_MAX_X, state.high + reach);
+    while (state.nextDecay <= time) {
+        state.desire = std::max(0, state.desire - rules.decayAmount);
+        if (!isSafe(state.desire, state.minSafe, state.maxSafe)) {
+            state.time = state.nextDecay;
+            return false;
+        }
+        state.nextDecay += rules.decayInterval * REFERENCE_FPS;
+    }
+    state.time = time;
+    return true;
+}
+
+float LookaheadPlanner::leafValue(const PlanState& state) const {
+    const int chances[3] = {rules.redChance, rules.goldenChance, 100 - rules.redChance - rules.goldenChance};
+    const AppleType types[3] = {AppleType::RED, AppleType::GOLDEN, AppleType::ROTTEN};
+    const bool missSafe = isSafe(clampDesire(state.desire + rules.missDesire), state.minSafe, state.maxSafe);
+    int answerable = 0;
+    for (int t = 0; t < 3; ++t) {
+        int caught = clampDesire(state.desire + appleDesireDelta(rules, types[t]));
+        if (missSafe || isSafe(caught, state.minSafe, state.maxSafe)) {
+            answerable += chances[t];
+        }
+    }
+    int margin = std::min(state.desire - state.minSafe, state.maxSafe - state.desire);
+    return static_cast<float>(state.score) + SAFETY_WEIGHT * answerable / 100.f + MARGIN_WEIGHT * margin;
+}
+
+void LookaheadPlanner::record(float value) {
+    if (value > iterationBest) {
+        iterationBest = value;
+        std::copy(path, path + horizon, iterationChoices);
+    }
+}
+
+void LookaheadPlanner::search(int event, PlanState state) {
+    if (aborted) {
+        return;
+    }
+    nodes++;
+    if (horizon > 1 && (nodes >= nodeLimit || (timed && nodes % CLOCK_INTERVAL == 0 && Clock::now() >= deadline))) {
+        aborted = true;
+        return;
+    }
+
+    while (event < eventCount && events[event].apple != FORCED_MISS && events[event].apple >= horizon) {
+        event++;
+    }
+    if (event == eventCount) {
+        record(leafValue(state));
+        return;
+    }
+    if (static_cast<float>(state.score) + scoreBound[event] + LEAF_BONUS_MAX <= iterationBest) {
+        return;
+    }
+
+    const Event& next = events[event];
+    if (!advance(state, next.time)) {
+        record(DEATH_VALUE + state.time);
+        return;
+    }
+
+    if (next.kind == EventKind::LAND) {
+        if (next.apple == FORCED_MISS || path[next.apple] != CATCH) {
+            state.desire = clampDesire(state.desire + rules.missDesire);
+            if (!isSafe(state.desire, state.minSafe, state.maxSafe)) {
+                record(DEATH_VALUE + state.time);
+                return;
+            }
+        }
+        search(event + 1, state);
+        return;
+    }
+
+    const PlanApple& apple = apples[next.apple];
+    const float dodgeLeft = apple.center - CATCH_HALF_WIDTH - DODGE_MARGIN;
+    const float dodgeRight = apple.center + CATCH_HALF_WIDTH + DODGE_MARGIN;
+
+    if (next.kind == EventKind::LEAVE) {
+        // A dodge holds its side until the apple has passed
+        Choice choice = path[next.apple];
+        if (choice == DODGE_LEFT) {
+            state.high = std::min(state.high, dodgeLeft);
+        } else if (choice == DODGE_RIGHT) {
+            state.low = std::max(state.low, dodgeRight);
+        }
+        if (state.low <= state.high) {
+            search(event + 1, state);
+        }
+        return;
+    }
+
+    // Previous plan first, then the catch, then the nearer dodge
+    Choice choices[4];
+    int choiceCount = 0;
+    if (pv[next.apple] != UNPLANNED) {
+        choices[choiceCount++] = pv[next.apple];
+    }
+    bool leftFirst = (state.low + state.high) / 2.f < apple.center;
+    const Choice defaults[3] = {CATCH, leftFirst ? DODGE_LEFT : DODGE_RIGHT, leftFirst ? DODGE_RIGHT : DODGE_LEFT};
+    for (Choice choice : defaults) {
+        if (choice != pv[next.apple]) {
+            choices[choiceCount++] = choice;
+        }
+    }
+
+    bool feasible = false;
+    for (int c = 0; c < choiceCount && !aborted; ++c) {
+        PlanState child = state;
+        switch (choices[c]) {
+            case CATCH:
+                child.low = std::max(child.low, apple.center - CATCH_HALF_WIDTH + CATCH_INSET);
+                child.high = std::min(child.high, apple.center + CATCH_HALF_WIDTH - CATCH_INSET);
+                break;
+            case DODGE_LEFT:
+                child.high = std::min(child.high, dodgeLeft);
+                break;
+            case DODGE_RIGHT:
+                child.low = std::max(child.low, dodgeRight);
+                break;
+            case UNPLANNED:
+                break;
+        }
+        if (child.low > child.high) {
+            continue;
+        }
+        feasible = true;
+        path[next.apple] = choices[c];
+
+        if (choices[c] == CATCH) {
+            child.score += appleScore(rules, apple.type);
+            child.desire = clampDesire(child.desire + appleDesireDelta(rules, apple.type));
+            if (child.score >= child.nextNarrowScore) {
+                child.minSafe = std::min(rules.minSafeCap, child.minSafe + rules.rangeStep);
+                child.maxSafe = std::max(rules.maxSafeFloor, child.maxSafe - rules.rangeStep);
+                child.nextNarrowScore += rules.milestoneScore * 2;
+            }
+            if (!isSafe(child.desire, child.minSafe, child.maxSafe)) {
+                record(DEATH_VALUE + child.time);
+                continue;
+            }
+        }
+        search(event + 1, child);
+    }
+    path[next.apple] = UNPLANNED;
+    // Too close to the window's edge to call either way: judge the plan here
+    if (!feasible) {
+        record(leafValue(state));
+    }
+}
+
+void LookaheadPlanner::deepen(int depth) {
+    horizon = depth;
+    // Most score still to be had from each event on
+    scoreBound[eventCount] = 0;
+    for (int e = eventCount - 1; e >= 0; --e) {
+        const Event& event = events[e];
+        bool counts = event.kind == EventKind::ARRIVE && event.apple < horizon;
+        scoreBound[e] = scoreBound[e + 1] +
+                        (counts ? static_cast<float>(std::max(0, appleScore(rules, apples[event.apple].type))) : 0.f);
+    }
+    iterationBest = DEATH_VALUE * 2.f;
+    for (int a = 0; a < horizon; ++a) {
+        path[a] = UNPLANNED;
+        iterationChoices[a] = UNPLANNED;
+    }
+    search(0, root);
+}
+
+void LookaheadPlanner::commit() {
+    for (int a = 0; a < horizon; ++a) {
+        committed[a] = PlannedApple{apples[a].x, apples[a].type, now + apples[a].arrive, iterationChoices[a]};
+        pv[a] = iterationChoices[a];
+    }
+    planSize = horizon;
+    planValue = iterationBest;
+}
+
+void LookaheadPlanner::plan(const Simulation& sim, Clock::time_point until, std::size_t nodeCap) {
+    std::uint64_t seen = observe(sim);
+    nodes = 0;
+    nodeLimit = nodeCap;
+    deadline = until;
+    timed = until != Clock::time_point::max();
+    aborted = false;
+
+    int depth = 1;
+    if (seen == signature && planSize > 0) {
+        // Same apples: the plan still holds, carry on one deeper
+        depth = planSize + 1;
+    } else {
+        for (int a = 0; a < appleCount; ++a) {
+            pv[a] = plannedChoice(a);
+        }
+        planSize = 0;
+    }
+    signature = seen;
+
+    for (; depth <= appleCount && !aborted; ++depth) {
+        deepen(depth);
+        if (!aborted) {
+            commit();
+        }
+    }
+    lastNodes = nodes;
+}
+
+void LookaheadPlanner::plan(const Simulation& sim, std::size_t nodeCap) {
+    plan(sim, Clock::time_point::max(), nodeCap);
+}
+
+SimInput LookaheadPlanner::decide(const Simulation& sim) {
+    plan(sim, nodeBudget);
+    return steer(sim);
+}
+
+// Carries the committed choices forward from the basket's position, then
+// back from the last one, which leaves the positions at the first choice from
+// which the whole plan still works. The basket heads for the nearest of them.
+SimInput LookaheadPlanner::steer(const Simulation& sim) {
+    observe(sim);
+    const float basketX = sim.getBasket().x;
+    Choice choices[PLANNER_MAX_APPLES];
+    for (int a = 0; a < appleCount; ++a) {
+        choices[a] = plannedChoice(a);
+    }
+
+    float times[PLANNER_MAX_APPLES * 2];
+    float lows[PLANNER_MAX_APPLES * 2];
+    float highs[PLANNER_MAX_APPLES * 2];
+    int steps = 0;
+    float low = basketX;
+    float high = basketX;
+    float time = 0;
+    for (int e = 0; e < eventCount; ++e) {
+        const Event& event = events[e];
+        if (event.kind == EventKind::LAND || choices[event.apple] == UNPLANNED) {
+            continue;
+        }
+        Choice choice = choices[event.apple];
+        if (event.kind == EventKind::LEAVE && choice == CATCH) {
+            continue;
+        }
+        float reach = PLAYER_SPEED * (event.time - time);
+        low = std::max(BASKET_MIN_X, low - reach);
+        high = std::min(BASKET_MAX_X, high + reach);
+        time = event.time;
+
+        float center = apples[event.apple].center;
+        if (choice == CATCH) {
+            low = std::max(low, center - CATCH_HALF_WIDTH + CATCH_INSET);
+            high = std::min(high, center + CATCH_HALF_WIDTH - CATCH_INSET);
+        } else if (choice == DODGE_LEFT) {
+            high = std::min(high, center - CATCH_HALF_WIDTH - DODGE_MARGIN);
+        } else {
+            low = std::max(low, center + CATCH_HALF_WIDTH + DODGE_MARGIN);
+        }
+        if (low > high) {
+            invalidate();
+            return SimInput();
+        }
+        times[steps] = time;
+        lows[steps] = low;
+        highs[steps] = high;
+        steps++;
+    }
+
+    // Nothing planned: wait mid-field, where the next apple is nearest on average
+    float targetLow = static_cast<float>(WIDTH) / 2.f - PLAYER_SPEED;
+    float targetHigh = static_cast<float>(WIDTH) / 2.f + PLAYER_SPEED;
+    if (steps > 0) {
+        for (int s = steps - 2; s >= 0; --s) {
+            float reach = PLAYER_SPEED * (times[s + 1] - times[s]);
+            lows[s] = std::max(lows[s], lows[s + 1] - reach);
+            highs[s] = std::min(highs[s], highs[s + 1] + reach);
+        }
+        targetLow = lows[0];
+        targetHigh = highs[0];
+    }
+
+    SimInput input;
+    if (basketX < targetLow) {
+        input.right = true;
+    } else if (basketX > targetHigh) {
+        input.left = true;
+    }
+    return input;
+}
+
+PlannerStats LookaheadPlanner::getStats() const {
+    return PlannerStats{planSize, appleCount, lastNodes, planValue};
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "bot_policy.hpp"
+
+// Most apples, nearest first, one search looks ahead over
+const int PLANNER_MAX_APPLES = 16;
+// Nodes per decide() when the planner runs as a bot policy
+const std::size_t PLANNER_DEFAULT_NODES = 4000;
+
+struct PlannerStats {
+    // Apples the current plan covers, out of those in view
+    int depth;
+    int apples;
+    // Nodes the last plan() call searched; 0 when the plan was already complete
+    std::size_t nodes;
+    float value;
+};
+
+// Anytime lookahead autopilot. Each apple in view is caught, or dodged to
+// the left or the right; the search walks those choices in landing order,
+// tracking the interval of basket positions that can still carry them out,
+// the desire gauge, the safe range and the score, with the decay timer and
+// range milestones on the way. Plans that leave the safe range are dead;
+// surviving ones are scored by points plus how likely the gauge is to ride
+// out the next apple drawn from the spawn odds.
+//
+// plan() deepens one apple at a time until its deadline or node budget and
+// keeps the deepest completed plan, so it can stop at any point with a
+// usable answer. The plan carries over between calls: while no apple spawns
+// or resolves, the next call resumes one apple deeper, and a complete plan
+// costs nothing. After a change the old plan orders the new search, which
+// mostly confirms it. steer() follows the plan from the current state and
+// never searches, so a game can plan once per frame and steer every tick.
+class LookaheadPlanner : public BotPolicy {
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    enum Choice : std::uint8_t {
+        CATCH,
+        DODGE_LEFT,
+        DODGE_RIGHT,
+        UNPLANNED
+    };
+
+    enum class EventKind : std::uint8_t {
+        // The apple reaches the basket's top: caught or dodged here
+        ARRIVE,
+        // Its top clears the basket's bottom: a dodge must hold until here
+        LEAVE,
+        // It hits the floor; a miss costs desire
+        LAND
+    };
+
+    struct PlanApple {
+        float center;
+        float x;
+        AppleType type;
+        // Reference frames from now
+        float arrive;
+        float leave;
+        float land;
+    };
+
+    struct Event {
+        float time;
+        EventKind kind;
+        // Index into apples, or FORCED_MISS for an apple already past the basket
+        std::uint8_t apple;
+    };
+
+    struct PlanState {
+        float time;
+        // Basket positions that can still carry out the choices so far
+        float low;
+        float high;
+        int desire;
+        int minSafe;
+        int maxSafe;
+        int score;
+        int nextNarrowScore;
+        float nextDecay;
+    };
+
+    // A committed choice, matched to apples by column, type and arrival
+    struct PlannedApple {
+        float x;
+        AppleType type;
+        float arriveAt;
+        Choice choice;
+    };
+
+    static const std::uint8_t FORCED_MISS = 0xFF;
+
+    std::size_t nodeBudget;
+    BalanceRules rules;
+
+    // The position the last plan() or steer() call saw
+    PlanApple apples[PLANNER_MAX_APPLES];
+    int appleCount;
+    Event events[PLANNER_MAX_APPLES * 3 + PLANNER_MAX_APPLES];
+    int eventCount;
+    float now;
+    PlanState root;
+    std::size_t order[APPLE_POOL_CAPACITY];
+
+    // Search of one horizon
+    int horizon;
+    Choice pv[PLANNER_MAX_APPLES];
+    Choice path[PLANNER_MAX_APPLES];
+    Choice iterationChoices[PLANNER_MAX_APPLES];
+    float iterationBest;
+    float scoreBound[PLANNER_MAX_APPLES * 3 + PLANNER_MAX_APPLES + 1];
+    std::size_t nodes;
+    std::size_t nodeLimit;
+    Clock::time_point deadline;
+    bool timed;
+    bool aborted;
+
+    // The committed plan and what it was searched for
+    PlannedApple committed[PLANNER_MAX_APPLES];
+    int planSize;
+    float planValue;
+    std::uint64_t signature;
+    std::size_t lastNodes;
+
+    std::uint64_t observe(const Simulation& sim);
+    Choice plannedChoice(int apple) const;
+    bool advance(PlanState& state, float time) const;
+    float leafValue(const PlanState& state) const;
+    void record(float value);
+    void search(int event, PlanState state);
+    void deepen(int depth);
+    void commit();
+
+public:
+    explicit LookaheadPlanner(std::size_t nodesPerDecide = PLANNER_DEFAULT_NODES);
+
+    const char* name() const override { return "planner"; }
+    void reset(std::uint64_t seed) override;
+
+    // Plans within the node budget, then steers
+    SimInput decide(const Simulation& sim) override;
+
+    // Searches until the deadline or nodeCap nodes, whichever comes first
+    void plan(const Simulation& sim, Clock::time_point until, std::size_t nodeCap = static_cast<std::size_t>(-1));
+    void plan(const Simulation& sim, std::size_t nodeCap);
+
+    // The input that follows the committed plan from the simulation's
+    // current state. A plan the game has drifted away from is dropped, so
+    // the next plan() starts afresh.
+    SimInput steer(const Simulation& sim);
+
+    // Forgets the plan so the next plan() searches from scratch
+    void invalidate();
+
+    PlannerStats getStats() const;
+};
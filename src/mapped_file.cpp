@@ -0,0 +1,67 @@
+#include "mapped_file.hpp"
+
+#include <cstdio>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() : data(nullptr), size(0), mapping(nullptr) {}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() {
+#if !defined(_WIN32)
+    if (mapping) {
+        munmap(mapping, size);
+    }
+#endif
+    mapping = nullptr;
+    fallback.clear();
+    data = nullptr;
+    size = 0;
+}
+
+bool MappedFile::open(const std::string& path, std::string& error) {
+    close();
+
+#if !defined(_WIN32)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "cannot open " + path;
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped != MAP_FAILED) {
+            mapping = mapped;
+            data = static_cast<const std::uint8_t*>(mapped);
+            size = static_cast<std::size_t>(info.st_size);
+        }
+    }
+    ::close(fd);
+#endif
+
+    if (!data) {
+        std::FILE* in = std::fopen(path.c_str(), "rb");
+        if (!in) {
+            error = "cannot open " + path;
+            return false;
+        }
+        std::uint8_t buffer[4096];
+        std::size_t read;
+        while ((read = std::fread(buffer, 1, sizeof(buffer), in)) > 0) {
+            fallback.insert(fallback.end(), buffer, buffer + read);
+        }
+        std::fclose(in);
+        data = fallback.data();
+        size = fallback.size();
+    }
+    return true;
+}
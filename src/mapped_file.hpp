@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A whole file as read-only bytes: memory-mapped where the platform allows it,
+// read into memory otherwise. The bytes stay valid until close() or destruction.
+class MappedFile {
+private:
+    const std::uint8_t* data;
+    std::size_t size;
+    void* mapping;
+    std::vector<std::uint8_t> fallback;
+
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // On failure error says why
+    bool open(const std::string& path, std::string& error);
+    void close();
+
+    const std::uint8_t* getData() const { return data; }
+    std::size_t getSize() const { return size; }
+};
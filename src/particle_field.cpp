@@ -0,0 +1,101 @@
+#include "particle_field.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "game_types.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+// Velocity kept per reference frame
+const float PARTICLE_DRAG = 0.97f;
+// Smallest chunk worth handing to a worker
+const std::size_t PARTICLE_GRAIN = 16384;
+
+}
+
+ParticleField::ParticleField(std::size_t capacity)
+    : count(0), x(capacity), y(capacity), vx(capacity), vy(capacity), gravity(capacity),
+      age(capacity), life(capacity), radius(capacity), color(capacity) {}
+
+bool ParticleField::spawn(float px, float py, float velocityX, float velocityY, float fall, float lifetime,
+                          float particleRadius, std::uint32_t rgba) {
+    if (count == x.size()) {
+        return false;
+    }
+    x[count] = px;
+    y[count] = py;
+    vx[count] = velocityX;
+    vy[count] = velocityY;
+    gravity[count] = fall;
+    age[count] = 0;
+    life[count] = lifetime;
+    radius[count] = particleRadius;
+    color[count] = rgba;
+    count++;
+    return true;
+}
+
+void ParticleField::updateRange(std::size_t begin, std::size_t end, float deltaTime, float stepScale,
+                                float damping) {
+    float* px = x.data();
+    float* py = y.data();
+    float* pvx = vx.data();
+    float* pvy = vy.data();
+    const float* fall = gravity.data();
+    float* elapsed = age.data();
+    for (std::size_t i = begin; i < end; ++i) {
+        pvy[i] += fall[i] * stepScale;
+        px[i] += pvx[i] * stepScale;
+        py[i] += pvy[i] * stepScale;
+        pvx[i] *= damping;
+        pvy[i] *= damping;
+        elapsed[i] += deltaTime;
+    }
+}
+
+void ParticleField::update(float deltaTime, ThreadPool* pool) {
+    const float stepScale = deltaTime * REFERENCE_FPS;
+    const float damping = std::pow(PARTICLE_DRAG, stepScale);
+    if (pool && count > PARTICLE_GRAIN) {
+        std::size_t grain = std::max(PARTICLE_GRAIN, (count + pool->size() - 1) / pool->size());
+        pool->parallelFor(count, grain, [&](std::size_t begin, std::size_t end) {
+            updateRange(begin, end, deltaTime, stepScale, damping);
+        });
+    } else {
+        updateRange(0, count, deltaTime, stepScale, damping);
+    }
+
+    std::size_t i = 0;
+    while (i < count) {
+        if (age[i] < life[i]) {
+            i++;
+            continue;
+        }
+        std::size_t last = --count;
+        x[i] = x[last];
+        y[i] = y[last];
+        vx[i] = vx[last];
+        vy[i] = vy[last];
+        gravity[i] = gravity[last];
+        age[i] = age[last];
+        life[i] = life[last];
+        radius[i] = radius[last];
+        color[i] = color[last];
+    }
+}
+
+int emitBurst(ParticleField& particles, CounterRng& rng, const ParticleBurst& burst, float px, float py) {
+    for (int n = 0; n < burst.count; ++n) {
+        float angle = burst.angle + (rng.uniformFloat() * 2.f - 1.f) * burst.spread;
+        float speed = burst.speedMin + (burst.speedMax - burst.speedMin) * rng.uniformFloat();
+        float lifetime = burst.lifeMin + (burst.lifeMax - burst.lifeMin) * rng.uniformFloat();
+        float particleRadius = burst.sizeMin + (burst.sizeMax - burst.sizeMin) * rng.uniformFloat();
+        if (!particles.spawn(px, py, std::cos(angle) * speed, std::sin(angle) * speed, burst.gravity,
+                             lifetime, particleRadius, burst.color)) {
+            return n;
+        }
+    }
+    return burst.count;
+}
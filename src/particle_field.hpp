@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "random.hpp"
+
+class ThreadPool;
+
+const std::size_t PARTICLE_CAPACITY = 131072;
+
+// Fixed-capacity pool of short-lived particles stored as parallel arrays, laid
+// out like AppleField so the update is a flat loop the compiler vectorizes.
+// Velocities and gravity are in pixels per 60 Hz reference frame, ages and
+// lifetimes in seconds. Expired particles are swapped out with the last one,
+// so spawning and expiring never allocate or shift.
+class ParticleField {
+private:
+    std::size_t count;
+
+    void updateRange(std::size_t begin, std::size_t end, float deltaTime, float stepScale, float damping);
+
+public:
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> vx;
+    std::vector<float> vy;
+    std::vector<float> gravity;
+    std::vector<float> age;
+    std::vector<float> life;
+    std::vector<float> radius;
+    // RGBA, as sf::Color::toInteger packs it
+    std::vector<std::uint32_t> color;
+
+    explicit ParticleField(std::size_t capacity);
+
+    std::size_t size() const { return count; }
+    std::size_t capacity() const { return x.size(); }
+    bool empty() const { return count == 0; }
+
+    void clear() { count = 0; }
+
+    // Returns false and drops the particle when the pool is full
+    bool spawn(float px, float py, float velocityX, float velocityY, float fall, float lifetime,
+               float particleRadius, std::uint32_t rgba);
+
+    // Moves, drags and ages every particle, then drops the expired ones. With
+    // a pool the move runs in chunks across its workers; the sweep stays serial.
+    void update(float deltaTime, ThreadPool* pool = nullptr);
+};
+
+// A spray of particles: count of them leave the point in directions within
+// spread radians of angle, speed, life and size rolled in their ranges
+struct ParticleBurst {
+    int count;
+    float angle;
+    float spread;
+    float speedMin;
+    float speedMax;
+    float lifeMin;
+    float lifeMax;
+    float sizeMin;
+    float sizeMax;
+    float gravity;
+    std::uint32_t color;
+};
+
+// Returns how many were spawned before the pool filled
+int emitBurst(ParticleField& particles, CounterRng& rng, const ParticleBurst& burst, float px, float py);
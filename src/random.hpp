@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+
+// Streams used by the game, so one seed drives independent sequences
+const std::uint64_t SPAWN_STREAM = 0;
+const std::uint64_t INTRO_STREAM = 1;
+const std::uint64_t BOT_STREAM = 2;
+const std::uint64_t SEED_STREAM = 3;
+const std::uint64_t AUDIO_STREAM = 4;
+const std::uint64_t PARTICLE_STREAM = 5;
+// VectorEnv environment i seeds its games from ENV_SEED_STREAM + i
+const std::uint64_t ENV_SEED_STREAM = 1ull << 32;
+
+// Counter-based generator: draw n of a stream is a pure hash of (key, n)
+// (the SplitMix64 output function), so every simulation owns a few bytes of
+// state, streams never share anything, and any seed/stream pair can be
+// recreated anywhere to get the same sequence bit for bit.
+class CounterRng {
+private:
+    std::uint64_t key;
+    std::uint64_t counter;
+
+    static std::uint64_t mix(std::uint64_t z) {
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+public:
+    using result_type = std::uint32_t;
+
+    explicit CounterRng(std::uint64_t seed = 0, std::uint64_t stream = 0) { reseed(seed, stream); }
+
+    void reseed(std::uint64_t seed, std::uint64_t stream = 0) {
+        key = mix(seed ^ mix(stream + 0x9E3779B97F4A7C15ull));
+        counter = 0;
+    }
+
+    std::uint64_t next64() {
+        return mix(key + ++counter * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::uint32_t operator()() { return static_cast<std::uint32_t>(next64() >> 32); }
+
+    // Uniform in [low, high], unbiased (multiply-shift with rejection)
+    int uniformInt(int low, int high) {
+        std::uint32_t range = static_cast<std::uint32_t>(high - low) + 1u;
+        std::uint64_t product = static_cast<std::uint64_t>((*this)()) * range;
+        std::uint32_t fraction = static_cast<std::uint32_t>(product);
+        if (fraction < range) {
+            std::uint32_t threshold = (0u - range) % range;
+            while (fraction < threshold) {
+                product = static_cast<std::uint64_t>((*this)()) * range;
+                fraction = static_cast<std::uint32_t>(product);
+            }
+        }
+        return low + static_cast<int>(product >> 32);
+    }
+
+    // Uniform in [0, 1)
+    float uniformFloat() { return static_cast<float>((*this)() >> 8) * (1.0f / 16777216.0f); }
+
+    std::uint64_t getCounter() const { return counter; }
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+};
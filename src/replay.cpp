@@ -0,0 +1,290 @@
+#include "replay.hpp"
+
+#include <cstring>
+
+#include "byte_order.hpp"
+
+namespace {
+
+// Encoded bytes are handed to the writer thread in chunks of about this size
+const std::size_t REPLAY_CHUNK_SIZE = 4096;
+
+std::uint8_t inputBits(const SimInput& input) {
+    return static_cast<std::uint8_t>((input.left ? 1 : 0) | (input.right ? 2 : 0));
+}
+
+// A key down for only part of the tick; such ticks are recorded one by one
+bool isPartial(const SimInput& input) {
+    return (input.left && input.leftHeld < INPUT_HOLD_FULL) || (input.right && input.rightHeld < INPUT_HOLD_FULL);
+}
+
+}
+
+ReplayRecorder::ReplayRecorder()
+    : file(nullptr), runInput(0), runLength(0), stopping(false) {
+    pending.reserve(REPLAY_CHUNK_SIZE);
+    writer = std::thread(&ReplayRecorder::writerLoop, this);
+}
+
+ReplayRecorder::~ReplayRecorder() {
+    if (file) {
+        flushRun();
+        handOff(true);
+        file = nullptr;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    writer.join();
+}
+
+void ReplayRecorder::writerLoop() {
+    std::vector<Chunk> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            batch.swap(queue);
+        }
+
+        for (auto& chunk : batch) {
+            if (!chunk.bytes.empty()) {
+                std::fwrite(chunk.bytes.data(), 1, chunk.bytes.size(), chunk.file);
+            }
+            if (chunk.close) {
+                std::fclose(chunk.file);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& chunk : batch) {
+            chunk.bytes.clear();
+            spareBuffers.push_back(std::move(chunk.bytes));
+        }
+        batch.clear();
+    }
+}
+
+void ReplayRecorder::emit(std::uint64_t value, std::uint8_t tag) {
+    std::uint64_t record = (value << 3) | tag;
+    do {
+        std::uint8_t byte = record & 0x7F;
+        record >>= 7;
+        pending.push_back(record ? static_cast<std::uint8_t>(byte | 0x80) : byte);
+    } while (record);
+}
+
+void ReplayRecorder::flushRun() {
+    if (runLength > 0) {
+        emit(runLength, runInput);
+        runLength = 0;
+    }
+    if (pending.size() >= REPLAY_CHUNK_SIZE) {
+        handOff(false);
+    }
+}
+
+void ReplayRecorder::handOff(bool close) {
+    std::vector<std::uint8_t> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(Chunk{file, std::move(pending), close});
+        if (!spareBuffers.empty()) {
+            next = std::move(spareBuffers.back());
+            spareBuffers.pop_back();
+        }
+    }
+    wake.notify_one();
+
+    pending = std::move(next);
+    pending.reserve(REPLAY_CHUNK_SIZE);
+}
+
+bool ReplayRecorder::begin(const std::string& path, std::uint64_t seed) {
+    if (file) {
+        flushRun();
+        handOff(true);
+        file = nullptr;
+    }
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    runInput = 0;
+    runLength = 0;
+
+    pending.insert(pending.end(), REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    putLittleEndian(pending, REPLAY_VERSION, 2);
+    putLittleEndian(pending, static_cast<std::uint64_t>(SIM_TICK_RATE), 2);
+    putLittleEndian(pending, seed, 8);
+    return true;
+}
+
+void ReplayRecorder::tick(const SimInput& input) {
+    if (!file) {
+        return;
+    }
+    if (isPartial(input)) {
+        flushRun();
+        std::uint64_t left = input.left ? input.leftHeld : 0;
+        std::uint64_t right = input.right ? input.rightHeld : 0;
+        emit(left | (right << 8), REPLAY_PARTIAL);
+        return;
+    }
+    std::uint8_t bits = inputBits(input);
+    if (bits != runInput && runLength > 0) {
+        flushRun();
+    }
+    runInput = bits;
+    runLength++;
+}
+
+void ReplayRecorder::pause() {
+    if (file) {
+        flushRun();
+        emit(0, REPLAY_PAUSE);
+    }
+}
+
+void ReplayRecorder::resume() {
+    if (file) {
+        emit(0, REPLAY_RESUME);
+    }
+}
+
+void ReplayRecorder::end(const Simulation& sim) {
+    if (!file) {
+        return;
+    }
+    flushRun();
+    emit(static_cast<std::uint64_t>(sim.getScore()), REPLAY_END);
+    pending.push_back(static_cast<std::uint8_t>(sim.getStatus()));
+    handOff(true);
+    file = nullptr;
+}
+
+ReplayLog::ReplayLog() : seed(0), tickRate(0) {}
+
+bool ReplayLog::open(const std::string& path, std::string& error) {
+    if (!file.open(path, error)) {
+        return false;
+    }
+    const std::uint8_t* data = file.getData();
+    std::size_t size = file.getSize();
+
+    if (size < REPLAY_HEADER_SIZE || std::memcmp(data, REPLAY_MAGIC, 4) != 0) {
+        error = path + " is not a replay";
+        file.close();
+        return false;
+    }
+    std::uint64_t version = getLittleEndian(data + 4, 2);
+    if (version < 1 || version > REPLAY_VERSION) {
+        error = path + " has an unsupported replay version";
+        file.close();
+        return false;
+    }
+    tickRate = static_cast<std::uint16_t>(getLittleEndian(data + 6, 2));
+    if (tickRate != static_cast<std::uint16_t>(SIM_TICK_RATE)) {
+        error = path + " was recorded at a different tick rate";
+        file.close();
+        return false;
+    }
+    seed = getLittleEndian(data + 8, 8);
+    return true;
+}
+
+ReplayCursor::ReplayCursor(const ReplayLog& log)
+    : position(log.bodyBegin()), end(log.bodyEnd()), remaining(0), pauses(0),
+      ended(false), corrupt(false), recordedScore(0), recordedStatus(SimStatus::RUNNING) {}
+
+bool ReplayCursor::readVarint(std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; position < end && shift < 64; shift += 7) {
+        std::uint8_t byte = *position++;
+        value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    corrupt = true;
+    return false;
+}
+
+bool ReplayCursor::next(SimInput& input) {
+    while (remaining == 0) {
+        if (ended || corrupt || position >= end) {
+            return false;
+        }
+        std::uint64_t record;
+        if (!readVarint(record)) {
+            return false;
+        }
+        std::uint8_t tag = record & 7u;
+        std::uint64_t value = record >> 3;
+
+        if (tag < 4) {
+            current.left = (tag & 1u) != 0;
+            current.right = (tag & 2u) != 0;
+            current.leftHeld = INPUT_HOLD_FULL;
+            current.rightHeld = INPUT_HOLD_FULL;
+            remaining = value;
+        } else if (tag == REPLAY_PARTIAL) {
+            if (value > 0xFFFFu) {
+                corrupt = true;
+                return false;
+            }
+            current.leftHeld = static_cast<std::uint8_t>(value & 0xFFu);
+            current.rightHeld = static_cast<std::uint8_t>(value >> 8);
+            current.left = current.leftHeld > 0;
+            current.right = current.rightHeld > 0;
+            remaining = 1;
+        } else if (tag == REPLAY_PAUSE) {
+            pauses++;
+        } else if (tag == REPLAY_END) {
+            if (position >= end) {
+                corrupt = true;
+                return false;
+            }
+            recordedScore = static_cast<int>(value);
+            recordedStatus = static_cast<SimStatus>(*position++);
+            ended = true;
+        } else if (tag != REPLAY_RESUME) {
+            corrupt = true;
+            return false;
+        }
+    }
+    remaining--;
+    input = current;
+    return true;
+}
+
+ReplayResult simulateReplay(const ReplayLog& log, const BalanceRules& rules) {
+    Simulation sim(rules, log.getSeed());
+    ReplayCursor cursor(log);
+    ReplayResult result;
+
+    SimInput input;
+    while (sim.getStatus() == SimStatus::RUNNING && cursor.next(input)) {
+        sim.step(input, SIM_TICK);
+        result.ticks++;
+    }
+    // Drain the log so trailing pause markers and the END record are seen
+    while (cursor.next(input)) {
+    }
+
+    result.score = sim.getScore();
+    result.status = sim.getStatus();
+    result.cause = sim.getCause();
+    result.pauses = cursor.getPauses();
+    result.hasEnd = cursor.hasEnd();
+    result.corrupt = cursor.isCorrupt();
+    result.recordedScore = cursor.getRecordedScore();
+    result.recordedStatus = cursor.getRecordedStatus();
+    return result;
+}
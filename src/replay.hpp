@@ -0,0 +1,144 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "simulation.hpp"
+
+// Input replay log. A 16-byte header (magic, version, tick rate, seed) is
+// followed by LEB128 varint records of (value << 3 | tag):
+//   tag 0-3  input bits (1 = left, 2 = right) held for `value` ticks
+//   PAUSE    the player paused (value unused)
+//   RESUME   the player resumed
+//   PARTIAL  one tick with keys down for part of it: `value` is the left and
+//            right SimInput hold, low byte first; a zero hold is a key up
+//   END      the game ended with score `value`; one SimStatus byte follows
+// Pauses do not advance the simulation, so only the tick records drive a replay.
+// Version 1 logs predate PARTIAL and read unchanged.
+const char REPLAY_MAGIC[4] = {'A', 'P', 'L', 'R'};
+const std::uint16_t REPLAY_VERSION = 2;
+const std::size_t REPLAY_HEADER_SIZE = 16;
+
+const std::uint8_t REPLAY_PAUSE = 4;
+const std::uint8_t REPLAY_RESUME = 5;
+const std::uint8_t REPLAY_PARTIAL = 6;
+const std::uint8_t REPLAY_END = 7;
+
+// Encodes one PLAYING session on the game thread and hands finished chunks to
+// a background thread that does the file I/O, so recording never blocks a tick.
+class ReplayRecorder {
+private:
+    struct Chunk {
+        std::FILE* file;
+        std::vector<std::uint8_t> bytes;
+        bool close;
+    };
+
+    std::FILE* file;
+    std::vector<std::uint8_t> pending;
+    std::uint8_t runInput;
+    std::uint64_t runLength;
+
+    std::vector<Chunk> queue;
+    std::vector<std::vector<std::uint8_t>> spareBuffers;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::thread writer;
+
+    void writerLoop();
+    void emit(std::uint64_t value, std::uint8_t tag);
+    void flushRun();
+    void handOff(bool close);
+
+public:
+    ReplayRecorder();
+    ~ReplayRecorder();
+
+    ReplayRecorder(const ReplayRecorder&) = delete;
+    ReplayRecorder& operator=(const ReplayRecorder&) = delete;
+
+    // Ends any session in progress first
+    bool begin(const std::string& path, std::uint64_t seed);
+    void tick(const SimInput& input);
+    void pause();
+    void resume();
+    // Records the final score and status (RUNNING for an abandoned game) and closes the file
+    void end(const Simulation& sim);
+
+    bool isRecording() const { return file != nullptr; }
+};
+
+// A replay file, memory-mapped where the platform allows it
+class ReplayLog {
+private:
+    MappedFile file;
+    std::uint64_t seed;
+    std::uint16_t tickRate;
+
+public:
+    ReplayLog();
+
+    ReplayLog(const ReplayLog&) = delete;
+    ReplayLog& operator=(const ReplayLog&) = delete;
+
+    // On failure error says why
+    bool open(const std::string& path, std::string& error);
+
+    std::uint64_t getSeed() const { return seed; }
+    std::uint16_t getTickRate() const { return tickRate; }
+    const std::uint8_t* bodyBegin() const { return file.getData() + REPLAY_HEADER_SIZE; }
+    const std::uint8_t* bodyEnd() const { return file.getData() + file.getSize(); }
+};
+
+// Walks a log tick by tick
+class ReplayCursor {
+private:
+    const std::uint8_t* position;
+    const std::uint8_t* end;
+    SimInput current;
+    std::uint64_t remaining;
+    int pauses;
+    bool ended;
+    bool corrupt;
+    int recordedScore;
+    SimStatus recordedStatus;
+
+    bool readVarint(std::uint64_t& value);
+
+public:
+    explicit ReplayCursor(const ReplayLog& log);
+
+    // Input for the next tick; false once the log has no ticks left
+    bool next(SimInput& input);
+
+    int getPauses() const { return pauses; }
+    bool hasEnd() const { return ended; }
+    bool isCorrupt() const { return corrupt; }
+    int getRecordedScore() const { return recordedScore; }
+    SimStatus getRecordedStatus() const { return recordedStatus; }
+};
+
+struct ReplayResult {
+    std::uint64_t ticks = 0;
+    int score = 0;
+    SimStatus status = SimStatus::RUNNING;
+    GameOverCause cause = GameOverCause::NONE;
+    int pauses = 0;
+    bool hasEnd = false;
+    bool corrupt = false;
+    int recordedScore = 0;
+    SimStatus recordedStatus = SimStatus::RUNNING;
+
+    // True if re-simulating reproduced the recorded outcome
+    bool matches() const { return hasEnd && !corrupt && score == recordedScore && status == recordedStatus; }
+};
+
+// Re-simulates the whole log headless, as fast as the simulation runs
+ReplayResult simulateReplay(const ReplayLog& log, const BalanceRules& rules = BalanceRules());
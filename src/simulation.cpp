@@ -0,0 +1,417 @@
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Timer wheel events
+const std::uint32_t SPAWN_EVENT = 0;
+const std::uint32_t DECAY_EVENT = 1;
+const std::uint32_t MILESTONE_EVENT = 2;
+const std::size_t EVENT_COUNT = 3;
+
+// A countdown of `seconds` fires on the first tick past it
+std::uint64_t ticksAfter(float seconds) {
+    return static_cast<std::uint64_t>(std::max(0.0, std::floor(seconds * static_cast<double>(SIM_TICK_RATE)))) + 1;
+}
+
+struct RuleField {
+    const char* name;
+    int BalanceRules::* intField;
+    float BalanceRules::* floatField;
+};
+
+const RuleField RULE_FIELDS[] = {
+    {"redScore", &BalanceRules::redScore, nullptr},
+    {"goldenScore", &BalanceRules::goldenScore, nullptr},
+    {"rottenScore", &BalanceRules::rottenScore, nullptr},
+    {"redDesire", &BalanceRules::redDesire, nullptr},
+    {"goldenDesire", &BalanceRules::goldenDesire, nullptr},
+    {"rottenDesire", &BalanceRules::rottenDesire, nullptr},
+    {"missDesire", &BalanceRules::missDesire, nullptr},
+    {"redChance", &BalanceRules::redChance, nullptr},
+    {"goldenChance", &BalanceRules::goldenChance, nullptr},
+    {"spawnInterval", nullptr, &BalanceRules::spawnInterval},
+    {"milestoneScore", &BalanceRules::milestoneScore, nullptr},
+    {"speedMultiplier", nullptr, &BalanceRules::speedMultiplier},
+    {"rangeStep", &BalanceRules::rangeStep, nullptr},
+    {"minSafeCap", &BalanceRules::minSafeCap, nullptr},
+    {"maxSafeFloor", &BalanceRules::maxSafeFloor, nullptr},
+    {"decayInterval", nullptr, &BalanceRules::decayInterval},
+    {"decayAmount", &BalanceRules::decayAmount, nullptr},
+    {"startDesire", &BalanceRules::startDesire, nullptr},
+    {"minDesire", &BalanceRules::minDesire, nullptr},
+    {"maxDesire", &BalanceRules::maxDesire, nullptr},
+    {"duration", nullptr, &BalanceRules::duration},
+};
+
+}
+
+bool setBalanceRule(BalanceRules& rules, const std::string& name, float value) {
+    for (const RuleField& field : RULE_FIELDS) {
+        if (name != field.name) {
+            continue;
+        }
+        if (field.intField) {
+            rules.*field.intField = static_cast<int>(std::lround(value));
+        } else {
+            rules.*field.floatField = value;
+        }
+        rules.milestoneScore = std::max(1, rules.milestoneScore);
+        return true;
+    }
+    return false;
+}
+
+const std::vector<std::string>& balanceRuleNames() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (const RuleField& field : RULE_FIELDS) {
+            result.push_back(field.name);
+        }
+        return result;
+    }();
+    return names;
+}
+
+Simulation::Simulation(const BalanceRules& balanceRules, std::uint64_t gameSeed, int players)
+    : rules(balanceRules), seed(gameSeed), apples(APPLE_POOL_CAPACITY), grid(APPLE_POOL_CAPACITY) {
+    resolved.reserve(APPLE_POOL_CAPACITY);
+    resolvedScratch.reserve(APPLE_POOL_CAPACITY);
+    hits.reserve(APPLE_POOL_CAPACITY);
+    resolutions.reserve(APPLE_POOL_CAPACITY);
+    timers.reserve(EVENT_COUNT);
+    setPlayerCount(players);
+}
+
+void Simulation::setPlayerCount(int count) {
+    playerCount = std::max(1, std::min(MAX_PLAYERS, count));
+    players.resize(static_cast<std::size_t>(playerCount));
+    reset();
+}
+
+void Simulation::reset(std::uint64_t gameSeed) {
+    seed = gameSeed;
+    reset();
+}
+
+void Simulation::reset() {
+    rng.reseed(seed, SPAWN_STREAM);
+    apples.clear();
+    grid.clear();
+    gridInSync = true;
+    resolutions.clear();
+    // Baskets start evenly spread, a lone one in the middle
+    for (int p = 0; p < playerCount; ++p) {
+        Player& player = players[p];
+        player.basket.x = WIDTH * (p + 1.0f) / (playerCount + 1.0f);
+        player.basket.previousX = player.basket.x;
+        player.desire = DesireGauge{rules.startDesire, rules.minDesire, rules.maxDesire};
+        player.score = 0;
+        player.active = true;
+        player.cause = GameOverCause::NONE;
+    }
+    colliderCount = 0;
+    difficulty = Difficulty{APPLE_FALL_SPEED, 0, 0};
+    gameTime = 0;
+    tickClock = 0;
+    timers.clear();
+    std::uint64_t spawnTicks = ticksAfter(rules.spawnInterval);
+    std::uint64_t decayTicks = ticksAfter(rules.decayInterval);
+    timers.schedule(spawnTicks, SPAWN_EVENT, spawnTicks);
+    timers.schedule(decayTicks, DECAY_EVENT, decayTicks);
+    nextMilestoneScore = rules.milestoneScore;
+    status = SimStatus::RUNNING;
+    cause = GameOverCause::NONE;
+}
+
+// A single basket is tested inside the fused SIMD move pass, which beats any
+// broadphase bookkeeping. Several go through the grid, so each costs the cells
+// it covers instead of another pass over every apple. The grid only follows
+// removals it sees, so it is rebuilt when it comes back into use.
+void Simulation::resolveApples(float stepScale) {
+    resolved.clear();
+    hits.clear();
+    if (colliderCount == 1) {
+        advanceApples(apples, colliders[0], stepScale, resolved);
+        gridInSync = false;
+        return;
+    }
+    advanceApples(apples, NO_BASKET, stepScale, resolved);
+    if (!gridInSync) {
+        grid.clear();
+        gridInSync = true;
+    }
+    grid.update(apples);
+    grid.collide(apples, colliders, colliderCount, hits);
+    awardConflicts();
+    mergeCatches(hits, resolved, resolvedScratch);
+}
+
+// Cuts hits down to one per apple. Hits arrive by apple then collider, and
+// colliders are in player order, so keeping the first of equally near
+// baskets favours the lower player index.
+void Simulation::awardConflicts() {
+    std::size_t kept = 0;
+    float keptDistance = 0;
+    for (std::size_t h = 0; h < hits.size(); ++h) {
+        const Box& collider = colliders[hits[h].collider];
+        float distance = std::fabs(collider.left + collider.width / 2.f -
+                                   (apples.x[hits[h].apple] + APPLE_RADIUS));
+        if (kept > 0 && hits[kept - 1].apple == hits[h].apple) {
+            if (distance < keptDistance) {
+                hits[kept - 1] = hits[h];
+                keptDistance = distance;
+            }
+        } else {
+            hits[kept++] = hits[h];
+            keptDistance = distance;
+        }
+    }
+    hits.resize(kept);
+}
+
+SimEvents Simulation::step(const SimInput& input, float deltaTime) {
+    SimInput inputs[MAX_PLAYERS];
+    inputs[0] = input;
+    return step(inputs, deltaTime);
+}
+
+SimEvents Simulation::step(const SimInput* inputs, float deltaTime) {
+    SimEvents events;
+    resolutions.clear();
+    if (status != SimStatus::RUNNING) {
+        return events;
+    }
+
+    gameTime += deltaTime;
+    tickClock += static_cast<double>(deltaTime) * SIM_TICK_RATE;
+    bool spawnDue = false;
+    bool decay = false;
+    bool milestoneDue = false;
+    timers.advanceTo(static_cast<std::uint64_t>(tickClock), [&](std::uint32_t event) {
+        spawnDue |= event == SPAWN_EVENT;
+        decay |= event == DECAY_EVENT;
+        milestoneDue |= event == MILESTONE_EVENT;
+    });
+    if (milestoneDue) {
+        applyMilestones(events);
+    }
+
+    if (gameTime >= rules.duration) {
+        bool anySafe = false;
+        for (int p = 0; p < playerCount; ++p) {
+            if (!players[p].active) {
+                continue;
+            }
+            if (players[p].desire.isSafe()) {
+                anySafe = true;
+            } else {
+                eliminate(p, GameOverCause::TIMES_UP, events);
+            }
+        }
+        if (anySafe) {
+            finish(SimStatus::VICTORY, GameOverCause::NONE, events);
+        } else {
+            finish(SimStatus::GAME_OVER, GameOverCause::TIMES_UP, events);
+        }
+        return events;
+    }
+
+    const float stepScale = deltaTime * REFERENCE_FPS;
+    colliderCount = 0;
+    for (int p = 0; p < playerCount; ++p) {
+        Basket& basket = players[p].basket;
+        basket.previousX = basket.x;
+        if (!players[p].active) {
+            continue;
+        }
+        if (inputs[p].left) {
+            basket.x -= PLAYER_SPEED * stepScale * (inputs[p].leftHeld / static_cast<float>(INPUT_HOLD_FULL));
+        }
+        if (inputs[p].right) {
+            basket.x += PLAYER_SPEED * stepScale * (inputs[p].rightHeld / static_cast<float>(INPUT_HOLD_FULL));
+        }
+        basket.x = std::max(35.0f, std::min(basket.x, static_cast<float>(WIDTH) - 35.0f));
+        colliders[colliderCount] = basket.getBounds();
+        colliderPlayers[colliderCount] = p;
+        colliderCount++;
+    }
+
+    if (spawnDue) {
+        spawnApple();
+    }
+
+    // After resolveApples, hits holds the catcher of every caught apple in
+    // apple order (or is empty when a lone basket catches everything)
+    resolveApples(stepScale);
+    std::size_t hit = 0;
+    for (std::uint32_t code : resolved) {
+        std::uint32_t index = resolvedIndex(code);
+        if (resolvedKind(code) == APPLE_CAUGHT) {
+            int catcher = colliderPlayers[0];
+            if (!hits.empty()) {
+                while (hits[hit].apple != index) {
+                    hit++;
+                }
+                catcher = colliderPlayers[hits[hit].collider];
+            }
+            collectApple(players[catcher], apples.type[index], events);
+            resolutions.push_back(AppleResolution{apples.x[index], apples.y[index], apples.type[index], true, catcher});
+        } else {
+            missApple(events);
+            resolutions.push_back(AppleResolution{apples.x[index], apples.y[index], apples.type[index], false, -1});
+        }
+    }
+    if (gridInSync) {
+        grid.removeResolved(apples, resolved);
+    } else {
+        apples.removeResolved(resolved);
+    }
+
+    GameOverCause firstOut = GameOverCause::NONE;
+    int remaining = 0;
+    for (int p = 0; p < playerCount; ++p) {
+        Player& player = players[p];
+        if (!player.active) {
+            continue;
+        }
+        if (decay) {
+            player.desire.value = std::max(0, player.desire.value - rules.decayAmount);
+        }
+        if (player.desire.value < player.desire.minSafe) {
+            eliminate(p, GameOverCause::APATHY, events);
+        } else if (player.desire.value > player.desire.maxSafe) {
+            eliminate(p, GameOverCause::OBSESSION, events);
+        } else {
+            remaining++;
+            continue;
+        }
+        if (firstOut == GameOverCause::NONE) {
+            firstOut = player.cause;
+        }
+    }
+    if (remaining == 0) {
+        finish(SimStatus::GAME_OVER, firstOut, events);
+    } else {
+        checkMilestone();
+    }
+
+    return events;
+}
+
+// Milestones are settled at the start of the step after the leading score
+// reaches the next one, so only scoring steps look at them
+void Simulation::checkMilestone() {
+    int score = 0;
+    for (const Player& player : players) {
+        score = std::max(score, player.score);
+    }
+    if (score >= nextMilestoneScore) {
+        timers.schedule(1, MILESTONE_EVENT);
+        nextMilestoneScore = (score / rules.milestoneScore + 1) * rules.milestoneScore;
+    }
+}
+
+void Simulation::applyMilestones(SimEvents& events) {
+    const int step = rules.milestoneScore;
+    int score = 0;
+    for (const Player& player : players) {
+        score = std::max(score, player.score);
+    }
+
+    if (score >= step) {
+        int currentMilestone = (score / step) * step;
+        if (currentMilestone > difficulty.lastSpeedIncreaseScore && (currentMilestone / step) % 2 == 1) {
+            difficulty.appleSpeed *= rules.speedMultiplier;
+            difficulty.lastSpeedIncreaseScore = currentMilestone;
+            events.speedIncreased = true;
+        }
+    }
+
+    if (score >= step * 2) {
+        int currentMilestone = (score / step) * step;
+        if (currentMilestone > difficulty.lastRangeDecreaseScore && (currentMilestone / step) % 2 == 0) {
+            for (Player& player : players) {
+                DesireGauge& desire = player.desire;
+                desire.minSafe = std::min(rules.minSafeCap, desire.minSafe + rules.rangeStep);
+                desire.maxSafe = std::max(rules.maxSafeFloor, desire.maxSafe - rules.rangeStep);
+            }
+            difficulty.lastRangeDecreaseScore = currentMilestone;
+            events.rangeNarrowed = true;
+        }
+    }
+}
+
+bool Simulation::spawnApple() {
+    float x = static_cast<float>(rng.uniformInt(30, WIDTH - 31));
+    int chance = rng.uniformInt(0, 99);
+
+    AppleType type;
+    if (chance < rules.redChance) {
+        type = AppleType::RED;
+    } else if (chance < rules.redChance + rules.goldenChance) {
+        type = AppleType::GOLDEN;
+    } else {
+        type = AppleType::ROTTEN;
+    }
+
+    return apples.spawn(x, -30.f, difficulty.appleSpeed, type);
+}
+
+void Simulation::collectApple(Player& player, AppleType type, SimEvents& events) {
+    events.collected[static_cast<int>(type)]++;
+
+    DesireGauge& desire = player.desire;
+    switch(type) {
+        case AppleType::RED:
+            player.score += rules.redScore;
+            desire.value += rules.redDesire;
+            break;
+        case AppleType::GOLDEN:
+            player.score += rules.goldenScore;
+            desire.value += rules.goldenDesire;
+            break;
+        case AppleType::ROTTEN:
+            player.score += rules.rottenScore;
+            desire.value += rules.rottenDesire;
+            break;
+    }
+    desire.value = std::max(0, std::min(100, desire.value));
+}
+
+void Simulation::missApple(SimEvents& events) {
+    events.missed++;
+    for (Player& player : players) {
+        if (player.active) {
+            player.desire.value = std::max(0, std::min(100, player.desire.value + rules.missDesire));
+        }
+    }
+}
+
+void Simulation::eliminate(int index, GameOverCause reason, SimEvents& events) {
+    players[index].active = false;
+    players[index].cause = reason;
+    events.eliminated |= 1u << index;
+}
+
+void Simulation::finish(SimStatus result, GameOverCause reason, SimEvents& events) {
+    status = result;
+    cause = reason;
+    events.finished = true;
+}
+
+const char* gameOverCauseText(GameOverCause cause) {
+    switch(cause) {
+        case GameOverCause::APATHY:
+            return "Apathy - You lost the will to live";
+        case GameOverCause::OBSESSION:
+            return "Obsession - Consumed by greed";
+        case GameOverCause::TIMES_UP:
+            return "Time's up!";
+        case GameOverCause::NONE:
+            break;
+    }
+    return "";
+}
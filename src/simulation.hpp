@@ -0,0 +1,223 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "apple_field.hpp"
+#include "apple_grid.hpp"
+#include "game_types.hpp"
+#include "random.hpp"
+#include "timer_wheel.hpp"
+
+// Tunable balance rules. Defaults reproduce the shipped game.
+struct BalanceRules {
+    int redScore = 20;
+    int goldenScore = 80;
+    int rottenScore = 5;
+    int redDesire = 20;
+    int goldenDesire = -10;
+    int rottenDesire = 40;
+    int missDesire = -10;
+
+    // Spawn odds in percent, rotten takes the remainder
+    int redChance = 60;
+    int goldenChance = 20;
+    float spawnInterval = 2.0f;
+
+    // Speed rises on odd multiples of milestoneScore, the safe range narrows on even ones
+    int milestoneScore = 200;
+    float speedMultiplier = 1.5f;
+    int rangeStep = 5;
+    int minSafeCap = 45;
+    int maxSafeFloor = 55;
+
+    float decayInterval = 10.0f;
+    int decayAmount = 1;
+
+    int startDesire = 50;
+    int minDesire = MIN_DESIRE;
+    int maxDesire = MAX_DESIRE;
+    float duration = static_cast<float>(GAME_DURATION);
+};
+
+// Sets a rule by its field name, returns false for unknown names
+bool setBalanceRule(BalanceRules& rules, const std::string& name, float value);
+const std::vector<std::string>& balanceRuleNames();
+
+enum class SimStatus {
+    RUNNING,
+    VICTORY,
+    GAME_OVER
+};
+
+enum class GameOverCause {
+    NONE,
+    APATHY,
+    OBSESSION,
+    TIMES_UP
+};
+
+struct Basket {
+    float x;
+    // Position before the latest step, for render interpolation
+    float previousX;
+
+    // Matches the outlined, center-origin rectangle drawn by the front-end
+    Box getBounds() const {
+        return Box{x - BASKET_WIDTH / 2.f - BASKET_OUTLINE,
+                   BASKET_Y - BASKET_HEIGHT / 2.f - BASKET_OUTLINE,
+                   BASKET_WIDTH + BASKET_OUTLINE * 2.f,
+                   BASKET_HEIGHT + BASKET_OUTLINE * 2.f};
+    }
+};
+
+struct DesireGauge {
+    int value;
+    int minSafe;
+    int maxSafe;
+
+    bool isSafe() const {
+        return value >= minSafe && value <= maxSafe;
+    }
+};
+
+// A local player: their own basket, gauge and score, all catching from the
+// shared apple field. A player whose gauge leaves the safe range is out and
+// their basket leaves the field; the game ends once nobody is left.
+struct Player {
+    Basket basket;
+    DesireGauge desire;
+    int score;
+    bool active;
+    GameOverCause cause;
+};
+
+const int MAX_PLAYERS = 8;
+
+struct Difficulty {
+    float appleSpeed;
+    int lastSpeedIncreaseScore;
+    int lastRangeDecreaseScore;
+};
+
+// A key's share of a step is kept in 255ths, so replays store it exactly
+const std::uint8_t INPUT_HOLD_FULL = 255;
+
+struct SimInput {
+    bool left = false;
+    bool right = false;
+    // How much of the step each key was down, for input timed between ticks;
+    // bots and whole-tick input leave them full
+    std::uint8_t leftHeld = INPUT_HOLD_FULL;
+    std::uint8_t rightHeld = INPUT_HOLD_FULL;
+};
+
+// What happened during one step, so the front-end can play sounds and show notifications
+struct SimEvents {
+    int collected[3] = {0, 0, 0};
+    int missed = 0;
+    bool speedIncreased = false;
+    bool rangeNarrowed = false;
+    bool finished = false;
+    // Players knocked out this step, one bit per player index
+    unsigned eliminated = 0;
+
+    int collectedTotal() const {
+        return collected[0] + collected[1] + collected[2];
+    }
+};
+
+// Where an apple was when it was caught or missed, for effects
+struct AppleResolution {
+    float x;
+    float y;
+    AppleType type;
+    bool caught;
+    // The catching player, -1 for a miss
+    int player;
+};
+
+// Headless game rules. step() advances everything by deltaTime: motion is
+// scaled from the per-reference-frame speeds, and the spawn, decay and
+// milestone timers run on a timer wheel in SIM_TICK ticks, so a step only
+// does the work that came due. The front-end and the tools step at the fixed
+// SIM_TICK so every machine plays the same game.
+//
+// With several players, an apple touching more than one basket goes to the
+// basket whose centre is nearest the apple's, the lower player index on a
+// tie. Milestones follow the leading score and narrow every gauge, a miss
+// costs every player still in, and the game is a victory if anyone is still
+// in and safe when time runs out.
+class Simulation {
+private:
+    BalanceRules rules;
+    std::uint64_t seed;
+    CounterRng rng;
+    AppleField apples;
+    AppleGrid grid;
+    std::vector<std::uint32_t> resolved;
+    std::vector<std::uint32_t> resolvedScratch;
+    std::vector<AppleHit> hits;
+    std::vector<AppleResolution> resolutions;
+    bool gridInSync;
+    int playerCount;
+    std::vector<Player> players;
+    // The baskets still in play this step and the player each belongs to
+    Box colliders[MAX_PLAYERS];
+    int colliderPlayers[MAX_PLAYERS];
+    std::size_t colliderCount;
+    Difficulty difficulty;
+    float gameTime;
+    // Elapsed time in ticks, driving the wheel whatever the step length
+    double tickClock;
+    TimerWheel timers;
+    // Leading score that schedules the next milestone check
+    int nextMilestoneScore;
+    SimStatus status;
+    GameOverCause cause;
+
+    void resolveApples(float stepScale);
+    void awardConflicts();
+    void applyMilestones(SimEvents& events);
+    void checkMilestone();
+    void collectApple(Player& player, AppleType type, SimEvents& events);
+    void missApple(SimEvents& events);
+    void eliminate(int index, GameOverCause reason, SimEvents& events);
+    void finish(SimStatus result, GameOverCause reason, SimEvents& events);
+
+public:
+    explicit Simulation(const BalanceRules& balanceRules = BalanceRules(), std::uint64_t gameSeed = 0,
+                        int players = 1);
+
+    // Restarts the same game: the spawn stream rewinds to the start of the seed
+    void reset();
+    void reset(std::uint64_t gameSeed);
+    // Clamped to 1..MAX_PLAYERS; resets the game
+    void setPlayerCount(int count);
+    // Player 0's input; any other players hold still
+    SimEvents step(const SimInput& input, float deltaTime);
+    // One input per player
+    SimEvents step(const SimInput* inputs, float deltaTime);
+
+    // What the spawn timer does when it fires; false if the pool is full
+    bool spawnApple();
+
+    const BalanceRules& getRules() const { return rules; }
+    std::uint64_t getSeed() const { return seed; }
+    const AppleField& getApples() const { return apples; }
+    // Apples caught or missed by the last step, in the order they were scored
+    const std::vector<AppleResolution>& getResolutions() const { return resolutions; }
+    int getPlayerCount() const { return playerCount; }
+    const Player& getPlayer(int index) const { return players[index]; }
+    // Player 0's, which is the whole game in single player
+    const Basket& getBasket() const { return players[0].basket; }
+    const DesireGauge& getDesire() const { return players[0].desire; }
+    int getScore() const { return players[0].score; }
+    const Difficulty& getDifficulty() const { return difficulty; }
+    float getGameTime() const { return gameTime; }
+    SimStatus getStatus() const { return status; }
+    GameOverCause getCause() const { return cause; }
+};
+
+const char* gameOverCauseText(GameOverCause cause);
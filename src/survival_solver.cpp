@@ -0,0 +1,254 @@
+#include "survival_solver.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "bot_policy.hpp"
+#include "thread_pool.hpp"
+
+namespace {
+
+const int DESIRE_VALUES = 101;
+// Apples spawn this far above the playfield
+const float SPAWN_Y = -30.f;
+// Survival chances closer than this are a tie, settled by score
+const float SURVIVAL_EPSILON = 1.0e-6f;
+// Score rows per task
+const std::size_t MIN_ROW_CHUNK = 8;
+
+const AppleType TYPES[3] = {AppleType::RED, AppleType::GOLDEN, AppleType::ROTTEN};
+
+// Tick on which a countdown of `seconds` fires, as the simulation's timers do
+std::int64_t ticksAfter(float seconds) {
+    return static_cast<std::int64_t>(std::max(0.0, std::floor(seconds * static_cast<double>(SIM_TICK_RATE)))) + 1;
+}
+
+// Ticks from an apple's spawn to the one it reaches the basket on; it moves
+// on the tick it spawns
+std::int64_t fallTicks(float speed) {
+    const float perTick = speed * SIM_TICK * REFERENCE_FPS;
+    if (perTick <= 0) {
+        return static_cast<std::int64_t>(1) << 40;
+    }
+    return static_cast<std::int64_t>(std::ceil((CATCH_TOP - SPAWN_Y) / perTick)) - 1;
+}
+
+// Multiples of `period` in [from, to)
+int ticksBetween(std::int64_t period, std::int64_t from, std::int64_t to) {
+    from = std::max<std::int64_t>(from, 1);
+    if (to <= from) {
+        return 0;
+    }
+    return static_cast<int>((to - 1) / period - (from - 1) / period);
+}
+
+bool isBetter(float survival, float score, float bestSurvival, float bestScore) {
+    if (std::fabs(survival - bestSurvival) > SURVIVAL_EPSILON) {
+        return survival > bestSurvival;
+    }
+    return score > bestScore;
+}
+
+}
+
+SurvivalSolver::SurvivalSolver()
+    : stages(0), levels(0), scoreUnit(1), scoreSteps(1), stageSize(0), typeChance{0, 0, 0} {}
+
+std::size_t SurvivalSolver::stateIndex(int stage, int level, int step, int desire) const {
+    return static_cast<std::size_t>(stage) * stageSize +
+           (static_cast<std::size_t>(level) * scoreSteps + step) * DESIRE_VALUES + desire;
+}
+
+bool SurvivalSolver::solve(const BalanceRules& balanceRules, ThreadPool* pool) {
+    rules = balanceRules;
+    const int step = rules.milestoneScore;
+    if (step <= 0 || rules.redScore < 0 || rules.goldenScore < 0 || rules.rottenScore < 0 ||
+        rules.decayAmount < 0) {
+        stages = 0;
+        levels = 0;
+        survival.clear();
+        score.clear();
+        return false;
+    }
+
+    // Scores only move in multiples of the common divisor, which keeps the
+    // score-within-milestone dimension small
+    scoreUnit = std::gcd(std::gcd(rules.redScore, rules.goldenScore), std::gcd(rules.rottenScore, step));
+    scoreSteps = step / scoreUnit;
+
+    const std::int64_t spawnTicks = ticksAfter(rules.spawnInterval);
+    const std::int64_t decayTicks = ticksAfter(rules.decayInterval);
+    const std::int64_t endTick = static_cast<std::int64_t>(std::ceil(rules.duration * static_cast<double>(SIM_TICK_RATE)));
+    stages = static_cast<int>(std::max<std::int64_t>(0, (endTick - 1) / spawnTicks));
+
+    // Odds as spawnApple() draws them from 0..99
+    const int redCut = std::max(0, std::min(100, rules.redChance));
+    const int goldenCut = std::max(redCut, std::min(100, rules.redChance + rules.goldenChance));
+    typeChance[0] = redCut / 100.0;
+    typeChance[1] = (goldenCut - redCut) / 100.0;
+    typeChance[2] = (100 - goldenCut) / 100.0;
+
+    // Level m is m milestones passed: (m + 1) / 2 speed-ups and m / 2
+    // narrowings. Past the last level that changes the range or the fall time
+    // they all play the same, so they share one.
+    const int maxGain = std::max(rules.redScore, std::max(rules.goldenScore, rules.rottenScore));
+    const long long reachable = static_cast<long long>(stages) * maxGain / step;
+    const int lastLevel = static_cast<int>(std::min<long long>(reachable, SURVIVAL_MAX_LEVELS - 1));
+    std::vector<int> levelMin, levelMax;
+    std::vector<std::int64_t> levelFall;
+    float speed = APPLE_FALL_SPEED;
+    int low = rules.minDesire;
+    int high = rules.maxDesire;
+    levels = 1;
+    for (int m = 0; m <= lastLevel; ++m) {
+        if (m > 0 && m % 2 == 1) {
+            speed *= rules.speedMultiplier;
+        } else if (m > 0) {
+            low = std::min(rules.minSafeCap, low + rules.rangeStep);
+            high = std::max(rules.maxSafeFloor, high - rules.rangeStep);
+        }
+        levelMin.push_back(low);
+        levelMax.push_back(high);
+        levelFall.push_back(fallTicks(speed));
+        if (m > 0 && (low != levelMin[m - 1] || high != levelMax[m - 1] || levelFall[m] != levelFall[m - 1])) {
+            levels = m + 1;
+        }
+    }
+    minSafe.assign(levelMin.begin(), levelMin.begin() + levels);
+    maxSafe.assign(levelMax.begin(), levelMax.begin() + levels);
+
+    // Decay ticks between the previous apple's arrival and this one's (or the
+    // end of the game), timed at the current level's speed
+    decays.assign(static_cast<std::size_t>(stages + 1) * levels, 0);
+    timesUp.assign(static_cast<std::size_t>(stages + 1) * levels, 0);
+    for (int k = 0; k <= stages; ++k) {
+        for (int level = 0; level < levels; ++level) {
+            const std::int64_t previous = k > 0 ? k * spawnTicks + levelFall[level] : 0;
+            const std::int64_t arrival = (k + 1) * spawnTicks + levelFall[level];
+            const bool late = k == stages || arrival >= endTick;
+            const std::size_t slot = static_cast<std::size_t>(k) * levels + level;
+            timesUp[slot] = late ? 1 : 0;
+            decays[slot] = ticksBetween(decayTicks, previous, late ? endTick : arrival);
+        }
+    }
+
+    stageSize = static_cast<std::size_t>(levels) * scoreSteps * DESIRE_VALUES;
+    survival.assign(static_cast<std::size_t>(stages + 1) * stageSize, 0.f);
+    score.assign(survival.size(), 0.f);
+
+    const std::size_t rows = static_cast<std::size_t>(levels) * scoreSteps;
+    std::size_t grain = rows;
+    if (pool) {
+        const std::size_t tasks = static_cast<std::size_t>(pool->size()) * 4;
+        grain = std::max(MIN_ROW_CHUNK, (rows + tasks - 1) / tasks);
+    }
+    for (int k = stages; k >= 0; --k) {
+        if (!pool || rows <= grain) {
+            solveRows(k, 0, rows);
+        } else {
+            pool->parallelFor(rows, grain, [this, k](std::size_t begin, std::size_t end) {
+                solveRows(k, begin, end);
+            });
+        }
+    }
+    return true;
+}
+
+void SurvivalSolver::solveRows(int stage, std::size_t begin, std::size_t end) {
+    const int step = rules.milestoneScore;
+    for (std::size_t row = begin; row < end; ++row) {
+        const int level = static_cast<int>(row / scoreSteps);
+        const int position = static_cast<int>(row % scoreSteps);
+        const std::size_t slot = static_cast<std::size_t>(stage) * levels + level;
+        const int low = minSafe[level];
+        const int high = maxSafe[level];
+        const int decayLoss = decays[slot] * rules.decayAmount;
+        float* rowSurvival = &survival[stateIndex(stage, level, position, 0)];
+        float* rowScore = &score[stateIndex(stage, level, position, 0)];
+
+        // Decay only lowers the gauge, so the last tick is the one to check
+        if (timesUp[slot]) {
+            for (int d = 0; d < DESIRE_VALUES; ++d) {
+                const int decayed = std::max(0, d - decayLoss);
+                const bool safe = d >= low && d <= high && decayed >= low;
+                rowSurvival[d] = safe ? 1.f : 0.f;
+                rowScore[d] = 0.f;
+            }
+            continue;
+        }
+
+        // Each apple type's catch lands on one row of the next table, whatever the gauge
+        const float* caughtSurvival[3];
+        const float* caughtScore[3];
+        int gain[3];
+        int delta[3];
+        for (int t = 0; t < 3; ++t) {
+            gain[t] = appleScore(rules, TYPES[t]);
+            delta[t] = appleDesireDelta(rules, TYPES[t]);
+            const int total = position * scoreUnit + gain[t];
+            const int nextLevel = std::min(levels - 1, level + total / step);
+            const int nextPosition = (total % step) / scoreUnit;
+            const std::size_t next = stateIndex(stage + 1, nextLevel, nextPosition, 0);
+            caughtSurvival[t] = &survival[next];
+            caughtScore[t] = &score[next];
+        }
+        const float* missedSurvival = &survival[stateIndex(stage + 1, level, position, 0)];
+        const float* missedScore = &score[stateIndex(stage + 1, level, position, 0)];
+
+        for (int d = 0; d < DESIRE_VALUES; ++d) {
+            const int decayed = std::max(0, d - decayLoss);
+            if (d < low || d > high || decayed < low) {
+                rowSurvival[d] = 0.f;
+                rowScore[d] = 0.f;
+                continue;
+            }
+
+            const int missed = desireAfter(decayed, rules.missDesire);
+            const bool missSafe = missed >= low && missed <= high;
+            const float missSurvival = missSafe ? missedSurvival[missed] : 0.f;
+            const float missScore = missSafe ? missedScore[missed] : 0.f;
+
+            double expectedSurvival = 0;
+            double expectedScore = 0;
+            for (int t = 0; t < 3; ++t) {
+                if (typeChance[t] <= 0) {
+                    continue;
+                }
+                // The catch is checked against the current range here and the
+                // narrowed one, if it reached a milestone, by the next table
+                const int caught = desireAfter(decayed, delta[t]);
+                const bool catchSafe = caught >= low && caught <= high;
+                const float catchSurvival = catchSafe ? caughtSurvival[t][caught] : 0.f;
+                const float catchScore = gain[t] + (catchSafe ? caughtScore[t][caught] : 0.f);
+
+                if (isBetter(catchSurvival, catchScore, missSurvival, missScore)) {
+                    expectedSurvival += typeChance[t] * catchSurvival;
+                    expectedScore += typeChance[t] * catchScore;
+                } else {
+                    expectedSurvival += typeChance[t] * missSurvival;
+                    expectedScore += typeChance[t] * missScore;
+                }
+            }
+            rowSurvival[d] = static_cast<float>(expectedSurvival);
+            rowScore[d] = static_cast<float>(expectedScore);
+        }
+    }
+}
+
+SurvivalOdds SurvivalSolver::start() const {
+    return at(0, rules.startDesire, 0);
+}
+
+SurvivalOdds SurvivalSolver::at(int stage, int desire, int points) const {
+    if (survival.empty()) {
+        return SurvivalOdds{0, 0};
+    }
+    const int step = rules.milestoneScore;
+    points = std::max(0, points);
+    const int level = std::min(levels - 1, points / step);
+    const int position = (points % step) / scoreUnit;
+    const std::size_t index = stateIndex(std::max(0, std::min(stage, stages)), level, position,
+                                         std::max(0, std::min(DESIRE_VALUES - 1, desire)));
+    return SurvivalOdds{survival[index], score[index]};
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "simulation.hpp"
+
+class ThreadPool;
+
+// Milestone levels tracked before the rest are folded into the last one
+const int SURVIVAL_MAX_LEVELS = 256;
+
+struct SurvivalOdds {
+    // Chance of surviving to the end, and the mean final score, under best play
+    double survival;
+    double expectedScore;
+};
+
+// Exact best-play odds for a rule set, by backward induction instead of
+// simulated games. Survival only depends on the desire gauge, the score (for
+// milestones: the safe range and the apple speed tier) and how many apples
+// are left, so the solver walks the apples from the last one to the first
+// and, for every gauge value, milestone level and score within the
+// milestone, weighs each apple type by the spawn odds and picks whichever of
+// catching and letting it drop has the best chance of surviving, then the
+// best expected score. Decay ticks between apples follow each level's fall
+// speed, and the game ends on the clock like the simulation's.
+//
+// The model assumes every apple can be caught or dodged, one at a time, as
+// it reaches the basket: the odds are an upper bound on what any player or
+// bot can reach, not a prediction. Scores must not be negative.
+//
+// Tables are float rows of the 101 gauge values, one row per score state,
+// stacked per apple. A score change moves every gauge value to the same row,
+// so a row reads whole rows of the next apple's table, and rows are solved in
+// chunks across the pool's workers, one apple at a time.
+class SurvivalSolver {
+private:
+    BalanceRules rules;
+    int stages;
+    int levels;
+    int scoreUnit;
+    int scoreSteps;
+    std::size_t stageSize;
+
+    // Per milestone level
+    std::vector<int> minSafe;
+    std::vector<int> maxSafe;
+    // Per apple and level: decay ticks before the apple arrives, and whether
+    // time runs out first
+    std::vector<int> decays;
+    std::vector<std::uint8_t> timesUp;
+
+    double typeChance[3];
+
+    // Per apple, level, score step and gauge value
+    std::vector<float> survival;
+    std::vector<float> score;
+
+    void solveRows(int stage, std::size_t begin, std::size_t end);
+    std::size_t stateIndex(int stage, int level, int step, int desire) const;
+
+public:
+    SurvivalSolver();
+
+    // Rebuilds the tables for these rules; false if the model cannot take them
+    bool solve(const BalanceRules& balanceRules, ThreadPool* pool = nullptr);
+
+    // From the start of a game
+    SurvivalOdds start() const;
+
+    // Before apple `stage` (0-based in spawn order) reaches the basket, with
+    // the gauge at `desire` and `points` scored so far; expectedScore counts
+    // the points still to come
+    SurvivalOdds at(int stage, int desire, int points) const;
+
+    int getStageCount() const { return stages; }
+    int getLevelCount() const { return levels; }
+    std::size_t getStateCount() const { return survival.size(); }
+};
@@ -0,0 +1,155 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace {
+
+// Lets tasks submitted from a worker land on that worker's own deque
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local std::size_t currentWorker = 0;
+
+}
+
+void ThreadPool::WorkerQueue::pushBack(Task&& task) {
+    if (count == ring.size()) {
+        std::vector<Task> grown(std::max<std::size_t>(16, ring.size() * 2));
+        for (std::size_t i = 0; i < count; ++i) {
+            grown[i] = std::move(ring[(head + i) % ring.size()]);
+        }
+        ring.swap(grown);
+        head = 0;
+    }
+    ring[(head + count) % ring.size()] = std::move(task);
+    count++;
+}
+
+// Popped slots are emptied so captures are released with the task
+void ThreadPool::WorkerQueue::popBack(Task& task) {
+    Task& slot = ring[(head + count - 1) % ring.size()];
+    task = std::move(slot);
+    slot = nullptr;
+    count--;
+}
+
+void ThreadPool::WorkerQueue::popFront(Task& task) {
+    Task& slot = ring[head];
+    task = std::move(slot);
+    slot = nullptr;
+    head = (head + 1) % ring.size();
+    count--;
+}
+
+ThreadPool::ThreadPool(unsigned threadCount)
+    : queued(0), pending(0), nextQueue(0), steals(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    std::size_t index = currentPool == this ? currentWorker : nextQueue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->pushBack(std::move(task));
+        pending++;
+        queued++;
+    }
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wakeCondition.notify_one();
+    idleCondition.notify_all();
+}
+
+void ThreadPool::wait() {
+    while (pending > 0) {
+        Task task;
+        if (steal(queues.size(), task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        idleCondition.wait(lock, [this] { return pending == 0 || queued > 0; });
+    }
+}
+
+void ThreadPool::workerLoop(std::size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wakeCondition.wait(lock, [this] { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
+
+bool ThreadPool::popLocal(std::size_t index, Task& task) {
+    WorkerQueue& queue = *queues[index];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.count == 0) {
+        return false;
+    }
+    queue.popBack(task);
+    queued--;
+    return true;
+}
+
+bool ThreadPool::steal(std::size_t thief, Task& task) {
+    const std::size_t count = queues.size();
+    for (std::size_t offset = 1; offset <= count; ++offset) {
+        std::size_t victim = (thief + offset) % count;
+        if (victim == thief) {
+            continue;
+        }
+
+        WorkerQueue& queue = *queues[victim];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.count == 0) {
+            continue;
+        }
+        queue.popFront(task);
+        queued--;
+        if (thief < count) {
+            steals++;
+        }
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::runTask(Task& task) {
+    task();
+    if (--pending == 0) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        idleCondition.notify_all();
+    }
+}
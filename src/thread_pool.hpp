@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: it pops its own work
+// from the back and steals from the front of the others when it runs dry.
+// The deques are ring buffers that grow to the most tasks ever queued and are
+// reused, so submitting a task whose captures std::function keeps inline
+// (up to two pointers) does not allocate. Tasks must not throw.
+class ThreadPool {
+private:
+    using Task = std::function<void()>;
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::vector<Task> ring;
+        std::size_t head = 0;
+        std::size_t count = 0;
+
+        void pushBack(Task&& task);
+        void popBack(Task& task);
+        void popFront(Task& task);
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::mutex wakeMutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+    std::atomic<std::size_t> queued;
+    std::atomic<std::size_t> pending;
+    std::atomic<std::size_t> nextQueue;
+    std::atomic<std::size_t> steals;
+    bool stopping;
+
+    void workerLoop(std::size_t index);
+    bool popLocal(std::size_t index, Task& task);
+    bool steal(std::size_t thief, Task& task);
+    void runTask(Task& task);
+
+public:
+    // threadCount 0 uses every hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(Task task);
+
+    // Blocks until every submitted task has finished; the caller helps run them
+    void wait();
+
+    // Runs fn(begin, end) over [0, count) in chunks of at most grain items
+    template <typename Fn>
+    void parallelFor(std::size_t count, std::size_t grain, Fn fn) {
+        grain = grain > 0 ? grain : 1;
+        for (std::size_t begin = 0; begin < count; begin += grain) {
+            std::size_t end = begin + grain < count ? begin + grain : count;
+            submit([fn, begin, end] { fn(begin, end); });
+        }
+        wait();
+    }
+
+    unsigned size() const { return static_cast<unsigned>(workers.size()); }
+    std::size_t stealCount() const { return steals.load(); }
+};
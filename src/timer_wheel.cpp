@@ -0,0 +1,114 @@
+#include "timer_wheel.hpp"
+
+TimerWheel::TimerWheel() {
+    clear();
+}
+
+void TimerWheel::clear() {
+    for (std::int32_t& head : slots) {
+        head = -1;
+    }
+    freeTimers.clear();
+    for (std::size_t i = timers.size(); i-- > 0;) {
+        timers[i].pending = false;
+        timers[i].generation++;
+        freeTimers.push_back(static_cast<std::int32_t>(i));
+    }
+    now = 0;
+    pendingCount = 0;
+}
+
+void TimerWheel::reserve(std::size_t count) {
+    timers.reserve(count);
+    freeTimers.reserve(count);
+}
+
+// The slot a timer belongs in from where the wheel stands now
+void TimerWheel::link(std::int32_t index) {
+    Timer& timer = timers[index];
+    std::uint64_t distance = timer.due - now;
+    int level = 0;
+    while (level < LEVELS - 1 && distance >= (std::uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+    std::uint64_t slotTick = timer.due;
+    if (level == LEVELS - 1 && distance >= (std::uint64_t(1) << (SLOT_BITS * LEVELS))) {
+        // Out of range: park in the top slot that comes round last, to be relinked then
+        slotTick = now + (std::uint64_t(SLOTS - 1) << (SLOT_BITS * level));
+    }
+    timer.slot = level * SLOTS + ((slotTick >> (SLOT_BITS * level)) & (SLOTS - 1));
+    std::int32_t& head = slots[timer.slot];
+    timer.previous = -1;
+    timer.next = head;
+    if (head >= 0) {
+        timers[head].previous = index;
+    }
+    head = index;
+}
+
+void TimerWheel::unlink(std::int32_t index) {
+    Timer& timer = timers[index];
+    if (timer.previous >= 0) {
+        timers[timer.previous].next = timer.next;
+    } else {
+        slots[timer.slot] = timer.next;
+    }
+    if (timer.next >= 0) {
+        timers[timer.next].previous = timer.previous;
+    }
+}
+
+void TimerWheel::release(std::int32_t index) {
+    timers[index].pending = false;
+    timers[index].generation++;
+    freeTimers.push_back(index);
+    pendingCount--;
+}
+
+// Every 64^level ticks the next slot of that level is spread over the finer levels
+void TimerWheel::cascade(int level) {
+    std::uint32_t slot = (now >> (SLOT_BITS * level)) & (SLOTS - 1);
+    if (slot == 0 && level + 1 < LEVELS) {
+        cascade(level + 1);
+    }
+    std::int32_t index = slots[level * SLOTS + slot];
+    slots[level * SLOTS + slot] = -1;
+    while (index >= 0) {
+        std::int32_t next = timers[index].next;
+        link(index);
+        index = next;
+    }
+}
+
+TimerId TimerWheel::schedule(std::uint64_t delay, std::uint32_t event, std::uint64_t period) {
+    std::int32_t index;
+    if (!freeTimers.empty()) {
+        index = freeTimers.back();
+        freeTimers.pop_back();
+    } else {
+        index = static_cast<std::int32_t>(timers.size());
+        timers.push_back(Timer{});
+    }
+    Timer& timer = timers[index];
+    timer.due = now + (delay > 0 ? delay : 1);
+    timer.period = period;
+    timer.event = event;
+    timer.pending = true;
+    pendingCount++;
+    link(index);
+    return TimerId{static_cast<std::uint32_t>(index), timer.generation};
+}
+
+bool TimerWheel::isPending(TimerId id) const {
+    return id.index < timers.size() && timers[id.index].generation == id.generation &&
+           timers[id.index].pending;
+}
+
+void TimerWheel::cancel(TimerId id) {
+    if (!isPending(id)) {
+        return;
+    }
+    std::int32_t index = static_cast<std::int32_t>(id.index);
+    unlink(index);
+    release(index);
+}
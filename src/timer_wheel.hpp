@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Handle to a scheduled timer; stale handles (fired or cancelled) are ignored
+struct TimerId {
+    std::uint32_t index = ~0u;
+    std::uint32_t generation = 0;
+};
+
+// Hierarchical timer wheel over integer ticks. Four levels of 64 slots cover
+// 2^24 ticks (39 hours at SIM_TICK_RATE); a timer sits in the finest level
+// its distance allows and cascades down as its time approaches, so a tick
+// touches one slot, plus a coarser one every 64 ticks, and only timers that
+// are due run. Later timers park in the top level until they come in range.
+// Timers live in a pool that grows to the most ever pending and is reused.
+class TimerWheel {
+private:
+    static const int LEVELS = 4;
+    static const int SLOT_BITS = 6;
+    static const std::uint32_t SLOTS = 1u << SLOT_BITS;
+
+    struct Timer {
+        std::uint64_t due;
+        std::uint64_t period;
+        std::uint32_t event;
+        std::uint32_t generation;
+        std::int32_t previous;
+        std::int32_t next;
+        // Index into slots of the list it is linked in
+        std::uint32_t slot;
+        bool pending;
+    };
+
+    std::vector<Timer> timers;
+    std::vector<std::int32_t> freeTimers;
+    // LEVELS rows of SLOTS list heads
+    std::int32_t slots[LEVELS * SLOTS];
+    std::uint64_t now;
+    std::size_t pendingCount;
+
+    void link(std::int32_t index);
+    void unlink(std::int32_t index);
+    void release(std::int32_t index);
+    void cascade(int level);
+
+    template <typename Fn>
+    void fireSlot(Fn& fire) {
+        std::int32_t* head = &slots[now & (SLOTS - 1)];
+        while (*head >= 0) {
+            std::int32_t index = *head;
+            unlink(index);
+            Timer& timer = timers[index];
+            std::uint32_t event = timer.event;
+            if (timer.period > 0) {
+                timer.due += timer.period;
+                link(index);
+            } else {
+                release(index);
+            }
+            fire(event);
+        }
+    }
+
+public:
+    TimerWheel();
+
+    // Drops every timer and rewinds to tick 0
+    void clear();
+    // Sizes the pool for count timers pending at once, so scheduling up to
+    // that many never allocates
+    void reserve(std::size_t count);
+
+    // Fires event after delay ticks (at least 1), then every period ticks if period > 0
+    TimerId schedule(std::uint64_t delay, std::uint32_t event, std::uint64_t period = 0);
+    void cancel(TimerId id);
+    bool isPending(TimerId id) const;
+
+    // Steps to tick `target`, calling fire(event) for every timer that comes
+    // due on the way, in tick order
+    template <typename Fn>
+    void advanceTo(std::uint64_t target, Fn fire) {
+        while (now < target) {
+            now++;
+            if ((now & (SLOTS - 1)) == 0) {
+                cascade(1);
+            }
+            if (pendingCount > 0) {
+                fireSlot(fire);
+            }
+        }
+    }
+
+    std::uint64_t getNow() const { return now; }
+    std::size_t getPending() const { return pendingCount; }
+};
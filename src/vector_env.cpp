@@ -0,0 +1,100 @@
+#include "vector_env.hpp"
+
+#include <algorithm>
+
+#include "thread_pool.hpp"
+
+namespace {
+
+// Environments per task; enough that a chunk outweighs handing it to a worker
+const std::size_t ENV_MIN_CHUNK = 16;
+
+}
+
+VectorEnv::VectorEnv(std::size_t count, const BalanceRules& balanceRules, std::size_t slots, int repeat,
+                     ThreadPool* workers)
+    : rules(balanceRules), appleSlots(slots), ticksPerStep(std::max(1, repeat)), pool(workers), chunkSize(count),
+      stepActions(nullptr), stepObservations(nullptr), stepRewards(nullptr), stepDones(nullptr) {
+    envs.reserve(count);
+    episodeSeeds.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        envs.emplace_back(rules);
+        episodeSeeds.emplace_back(0, ENV_SEED_STREAM + i);
+    }
+    // A few chunks per worker so a slow chunk does not hold up the rest
+    if (pool) {
+        std::size_t tasks = static_cast<std::size_t>(pool->size()) * 4;
+        chunkSize = std::max(ENV_MIN_CHUNK, (count + tasks - 1) / tasks);
+    }
+}
+
+void VectorEnv::reset(std::uint64_t seed, float* observations) {
+    for (std::size_t i = 0; i < envs.size(); ++i) {
+        episodeSeeds[i].reseed(seed, ENV_SEED_STREAM + i);
+        envs[i].reset(episodeSeeds[i].next64());
+        observe(i, observations + i * getObservationSize());
+    }
+}
+
+void VectorEnv::step(const std::uint8_t* actions, float* observations, float* rewards, std::uint8_t* dones) {
+    stepActions = actions;
+    stepObservations = observations;
+    stepRewards = rewards;
+    stepDones = dones;
+    if (!pool || envs.size() <= chunkSize) {
+        stepRange(0, envs.size());
+        return;
+    }
+
+    // Only this and the chunk index are captured, which std::function keeps
+    // inline, so submitting a chunk does not allocate
+    for (std::size_t begin = 0; begin < envs.size(); begin += chunkSize) {
+        pool->submit([this, begin] { stepRange(begin, std::min(begin + chunkSize, envs.size())); });
+    }
+    pool->wait();
+}
+
+void VectorEnv::stepRange(std::size_t begin, std::size_t end) {
+    const std::size_t observationSize = getObservationSize();
+    for (std::size_t i = begin; i < end; ++i) {
+        Simulation& sim = envs[i];
+        SimInput input;
+        input.left = stepActions[i] == ENV_ACTION_LEFT;
+        input.right = stepActions[i] == ENV_ACTION_RIGHT;
+
+        const int scoreBefore = sim.getScore();
+        bool done = false;
+        for (int tick = 0; tick < ticksPerStep && !done; ++tick) {
+            done = sim.step(input, SIM_TICK).finished;
+        }
+        stepRewards[i] = static_cast<float>(sim.getScore() - scoreBefore);
+        stepDones[i] = done ? 1 : 0;
+        if (done) {
+            sim.reset(episodeSeeds[i].next64());
+        }
+        observe(i, stepObservations + i * observationSize);
+    }
+}
+
+void VectorEnv::observe(std::size_t index, float* observation) const {
+    const Simulation& sim = envs[index];
+    const DesireGauge& desire = sim.getDesire();
+    const AppleField& apples = sim.getApples();
+    const std::size_t shown = std::min(apples.size(), appleSlots);
+
+    observation[0] = sim.getBasket().x / WIDTH;
+    observation[1] = desire.value / 100.f;
+    observation[2] = desire.minSafe / 100.f;
+    observation[3] = desire.maxSafe / 100.f;
+    observation[4] = sim.getGameTime() / rules.duration;
+    observation[5] = static_cast<float>(apples.size()) / static_cast<float>(appleSlots);
+
+    float* slot = observation + ENV_HEADER_SIZE;
+    for (std::size_t i = 0; i < shown; ++i, slot += ENV_APPLE_STRIDE) {
+        slot[0] = apples.x[i] / WIDTH;
+        slot[1] = apples.y[i] / HEIGHT;
+        slot[2] = apples.speed[i];
+        slot[3] = static_cast<float>(static_cast<int>(apples.type[i]) + 1);
+    }
+    std::fill(slot, observation + getObservationSize(), 0.f);
+}
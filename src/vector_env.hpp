@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "random.hpp"
+#include "simulation.hpp"
+
+class ThreadPool;
+
+// Basket move per environment, one byte each in the actions buffer
+const std::uint8_t ENV_ACTION_STAY = 0;
+const std::uint8_t ENV_ACTION_LEFT = 1;
+const std::uint8_t ENV_ACTION_RIGHT = 2;
+
+// Observation layout, in floats from the start of an environment's row:
+//   0 basket x / WIDTH
+//   1 desire / 100
+//   2 safe range minimum / 100
+//   3 safe range maximum / 100
+//   4 game time / rules.duration
+//   5 apples on the field / apple slots
+// then apple slots of 4: x / WIDTH, y / HEIGHT, speed in pixels per
+// reference frame, and type (1 red, 2 golden, 3 rotten, 0 for an empty slot).
+// Apples past the slot count are left out.
+const std::size_t ENV_HEADER_SIZE = 6;
+const std::size_t ENV_APPLE_STRIDE = 4;
+const std::size_t ENV_DEFAULT_APPLE_SLOTS = 32;
+
+// K independent single-player games behind a reset/step interface for
+// training agents, rendering off. Every buffer is the caller's: observations
+// hold K rows of getObservationSize() floats, and step() fills them along
+// with one reward (score gained) and one done flag per environment, without
+// allocating. An environment that finishes restarts at once with the next
+// seed of its own stream and reports the new game's first observation.
+//
+// With a pool, environments are stepped in chunks across its workers; each
+// environment is only ever touched by one task, so results match the serial
+// run exactly.
+class VectorEnv {
+private:
+    BalanceRules rules;
+    std::vector<Simulation> envs;
+    // Environment i draws its games' seeds from stream ENV_SEED_STREAM + i
+    std::vector<CounterRng> episodeSeeds;
+    std::size_t appleSlots;
+    int ticksPerStep;
+    ThreadPool* pool;
+    std::size_t chunkSize;
+
+    // The step in flight, read by the chunk tasks
+    const std::uint8_t* stepActions;
+    float* stepObservations;
+    float* stepRewards;
+    std::uint8_t* stepDones;
+
+    void stepRange(std::size_t begin, std::size_t end);
+    void observe(std::size_t index, float* observation) const;
+
+public:
+    // ticksPerStep repeats each action for that many SIM_TICKs (frame skip)
+    VectorEnv(std::size_t count, const BalanceRules& balanceRules = BalanceRules(),
+              std::size_t slots = ENV_DEFAULT_APPLE_SLOTS, int ticksPerStep = 1, ThreadPool* workers = nullptr);
+
+    std::size_t size() const { return envs.size(); }
+    std::size_t getObservationSize() const { return ENV_HEADER_SIZE + appleSlots * ENV_APPLE_STRIDE; }
+    int getTicksPerStep() const { return ticksPerStep; }
+
+    // Restarts every environment; the same seed replays the same games
+    void reset(std::uint64_t seed, float* observations);
+
+    // actions holds one ENV_ACTION_* per environment
+    void step(const std::uint8_t* actions, float* observations, float* rewards, std::uint8_t* dones);
+
+    const Simulation& getEnv(std::size_t index) const { return envs[index]; }
+};
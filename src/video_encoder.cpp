@@ -0,0 +1,191 @@
+#include "video_encoder.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+
+namespace {
+
+// How long the encoder naps with nothing queued, and capture with nowhere to put a frame
+const std::chrono::microseconds IDLE_SLEEP(500);
+
+bool endsWith(const std::string& text, const char* suffix) {
+    const std::string tail(suffix);
+    return text.size() >= tail.size() && text.compare(text.size() - tail.size(), tail.size(), tail) == 0;
+}
+
+}
+
+void rgbaToI420(const std::uint8_t* rgba, unsigned width, unsigned height, std::uint8_t* yuv) {
+    std::uint8_t* lumaPlane = yuv;
+    std::uint8_t* bluePlane = yuv + static_cast<std::size_t>(width) * height;
+    std::uint8_t* redPlane = bluePlane + static_cast<std::size_t>(width / 2) * (height / 2);
+
+    // 16.16 fixed point; the +128 chroma offset is folded in before the shift
+    // so the sums never go negative
+    for (unsigned y = 0; y < height; y += 2) {
+        const std::uint8_t* top = rgba + static_cast<std::size_t>(y) * width * 4;
+        const std::uint8_t* bottom = top + static_cast<std::size_t>(width) * 4;
+        std::uint8_t* lumaTop = lumaPlane + static_cast<std::size_t>(y) * width;
+        std::uint8_t* lumaBottom = lumaTop + width;
+        std::uint8_t* blue = bluePlane + static_cast<std::size_t>(y / 2) * (width / 2);
+        std::uint8_t* red = redPlane + static_cast<std::size_t>(y / 2) * (width / 2);
+
+        for (unsigned x = 0; x < width; x += 2) {
+            const std::uint8_t* quad[4] = {top + x * 4, top + x * 4 + 4, bottom + x * 4, bottom + x * 4 + 4};
+            std::uint8_t* luma[4] = {lumaTop + x, lumaTop + x + 1, lumaBottom + x, lumaBottom + x + 1};
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (int i = 0; i < 4; ++i) {
+                const std::uint8_t* pixel = quad[i];
+                *luma[i] = static_cast<std::uint8_t>((19595 * pixel[0] + 38470 * pixel[1] + 7471 * pixel[2] + 32768) >> 16);
+                r += pixel[0];
+                g += pixel[1];
+                b += pixel[2];
+            }
+            // Chroma of the 2x2 block's average colour; the sums are 4x, so
+            // shift by 2 more; pure blue or red rounds up to 256
+            blue[x / 2] = static_cast<std::uint8_t>(std::min(255, (-11059 * r - 21709 * g + 32768 * b + (512 << 16) + (1 << 17)) >> 18));
+            red[x / 2] = static_cast<std::uint8_t>(std::min(255, (32768 * r - 27439 * g - 5329 * b + (512 << 16) + (1 << 17)) >> 18));
+        }
+    }
+}
+
+VideoEncoder::VideoEncoder()
+    : format(VideoFormat::Y4M), width(0), height(0), fps(0), frameSize(0), file(nullptr),
+      head(0), tail(0), closing(false), failed(false), dropped(0), peakQueued(0), encodeSeconds(0) {}
+
+VideoEncoder::~VideoEncoder() {
+    close();
+}
+
+bool VideoEncoder::open(const std::string& outputPath, unsigned frameWidth, unsigned frameHeight, unsigned frameRate,
+                        std::string& error, VideoImageWriter writer) {
+    close();
+    if (frameWidth == 0 || frameHeight == 0 || frameWidth % 2 != 0 || frameHeight % 2 != 0) {
+        error = "video frames must have an even, non-zero size";
+        return false;
+    }
+
+    path = outputPath;
+    width = frameWidth;
+    height = frameHeight;
+    fps = frameRate;
+    frameSize = static_cast<std::size_t>(width) * height * 4;
+    imageWriter = writer;
+
+    if (endsWith(path, ".y4m") || endsWith(path, ".rgba")) {
+        format = endsWith(path, ".y4m") ? VideoFormat::Y4M : VideoFormat::RAW;
+        file = std::fopen(path.c_str(), "wb");
+        if (!file) {
+            error = "cannot write " + path;
+            return false;
+        }
+        if (format == VideoFormat::Y4M) {
+            std::fprintf(file, "YUV4MPEG2 W%u H%u F%u:1 Ip A1:1 C420jpeg\n", width, height, fps);
+            converted.resize(static_cast<std::size_t>(width) * height * 3 / 2);
+        }
+    } else {
+        format = VideoFormat::IMAGES;
+        std::error_code created;
+        std::filesystem::create_directories(path, created);
+        if (!imageWriter || created) {
+            error = imageWriter ? "cannot create " + path : "no image writer for " + path;
+            return false;
+        }
+    }
+
+    slots.resize(frameSize * VIDEO_SLOTS);
+    head.store(0);
+    tail.store(0);
+    closing.store(false);
+    failed.store(false);
+    dropped = 0;
+    peakQueued = 0;
+    encodeSeconds = 0;
+    encoder = std::thread(&VideoEncoder::encoderLoop, this);
+    return true;
+}
+
+void VideoEncoder::encoderLoop() {
+    for (;;) {
+        const std::uint64_t next = tail.load(std::memory_order_relaxed);
+        if (next == head.load(std::memory_order_acquire)) {
+            // close() comes after the last submit(), so once it is seen
+            // another look at the head is final
+            if (!closing.load(std::memory_order_acquire)) {
+                std::this_thread::sleep_for(IDLE_SLEEP);
+            } else if (next == head.load(std::memory_order_acquire)) {
+                return;
+            }
+            continue;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        const std::uint8_t* frame = &slots[(next % VIDEO_SLOTS) * frameSize];
+        if (!failed.load(std::memory_order_relaxed) && !writeFrame(frame, next)) {
+            failed.store(true, std::memory_order_relaxed);
+        }
+        encodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        tail.store(next + 1, std::memory_order_release);
+    }
+}
+
+bool VideoEncoder::writeFrame(const std::uint8_t* rgba, std::uint64_t index) {
+    switch (format) {
+        case VideoFormat::Y4M:
+            rgbaToI420(rgba, width, height, converted.data());
+            return std::fputs("FRAME\n", file) >= 0 &&
+                   std::fwrite(converted.data(), 1, converted.size(), file) == converted.size();
+        case VideoFormat::RAW:
+            return std::fwrite(rgba, 1, frameSize, file) == frameSize;
+        case VideoFormat::IMAGES: {
+            char name[32];
+            std::snprintf(name, sizeof(name), "/frame-%06llu.png", static_cast<unsigned long long>(index));
+            return imageWriter(path + name, rgba, width, height);
+        }
+    }
+    return false;
+}
+
+std::uint8_t* VideoEncoder::acquire(bool wait) {
+    const std::uint64_t next = head.load(std::memory_order_relaxed);
+    while (next - tail.load(std::memory_order_acquire) >= VIDEO_SLOTS) {
+        if (!wait) {
+            return nullptr;
+        }
+        std::this_thread::sleep_for(IDLE_SLEEP);
+    }
+    return &slots[(next % VIDEO_SLOTS) * frameSize];
+}
+
+void VideoEncoder::submit() {
+    const std::uint64_t next = head.load(std::memory_order_relaxed) + 1;
+    peakQueued = std::max<std::size_t>(peakQueued, static_cast<std::size_t>(next - tail.load(std::memory_order_relaxed)));
+    head.store(next, std::memory_order_release);
+}
+
+void VideoEncoder::drop() {
+    dropped++;
+}
+
+bool VideoEncoder::close() {
+    if (!encoder.joinable()) {
+        return !failed.load();
+    }
+    closing.store(true, std::memory_order_release);
+    encoder.join();
+    if (file) {
+        if (std::fclose(file) != 0) {
+            failed.store(true);
+        }
+        file = nullptr;
+    }
+    return !failed.load();
+}
+
+// Only settled once close() has joined the encoder
+VideoStats VideoEncoder::getStats() const {
+    return VideoStats{tail.load(), dropped, peakQueued, encodeSeconds};
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Frames the encoder can fall behind by before capture has to drop or wait
+const std::size_t VIDEO_SLOTS = 8;
+
+enum class VideoFormat {
+    // YUV4MPEG2, 4:2:0 full range; plays in mpv and pipes straight into ffmpeg
+    Y4M,
+    // Bare RGBA frames, top row first (ffmpeg -f rawvideo -pix_fmt rgba)
+    RAW,
+    // One image file per frame in a directory, written by the caller's writer
+    IMAGES
+};
+
+// Writes one RGBA frame, top row first, as an image file
+using VideoImageWriter = std::function<bool(const std::string& path, const std::uint8_t* rgba,
+                                            unsigned width, unsigned height)>;
+
+struct VideoStats {
+    std::uint64_t written;
+    // Frames the game had no free slot for
+    std::uint64_t dropped;
+    std::size_t peakQueued;
+    // Time the encoder thread spent converting and writing
+    double encodeSeconds;
+};
+
+// Converts RGBA (top row first) to planar I420 with full-range BT.601, the
+// JPEG flavour Y4M calls C420jpeg; width and height must be even
+void rgbaToI420(const std::uint8_t* rgba, unsigned width, unsigned height, std::uint8_t* yuv);
+
+// Video file writer on its own thread. Frames go through a single-producer,
+// single-consumer ring of VIDEO_SLOTS preallocated RGBA frames: the game
+// thread fills the slot acquire() hands out and publishes it with submit(),
+// the encoder converts and writes it and frees the slot, and neither side
+// ever takes a lock. When the encoder falls behind, acquire() returns null
+// and a live game drops the frame (drop()) rather than miss its own frame
+// deadline; an offline export passes wait to block for a slot instead.
+class VideoEncoder {
+private:
+    VideoFormat format;
+    std::string path;
+    unsigned width;
+    unsigned height;
+    unsigned fps;
+    std::size_t frameSize;
+    std::FILE* file;
+    VideoImageWriter imageWriter;
+
+    std::vector<std::uint8_t> slots;
+    std::vector<std::uint8_t> converted;
+    // Frames published by the game thread, and frames the encoder has finished
+    std::atomic<std::uint64_t> head;
+    std::atomic<std::uint64_t> tail;
+    std::atomic<bool> closing;
+    std::atomic<bool> failed;
+    std::thread encoder;
+
+    std::uint64_t dropped;
+    std::size_t peakQueued;
+    double encodeSeconds;
+
+    void encoderLoop();
+    bool writeFrame(const std::uint8_t* rgba, std::uint64_t index);
+
+public:
+    VideoEncoder();
+    ~VideoEncoder();
+
+    VideoEncoder(const VideoEncoder&) = delete;
+    VideoEncoder& operator=(const VideoEncoder&) = delete;
+
+    // The format follows the path: .y4m, .rgba, or else a directory of
+    // frame-000000.png files through imageWriter
+    bool open(const std::string& outputPath, unsigned frameWidth, unsigned frameHeight, unsigned frameRate,
+              std::string& error, VideoImageWriter writer = nullptr);
+    bool isOpen() const { return encoder.joinable(); }
+
+    // The next free slot of width * height RGBA bytes, or null when every
+    // slot is queued and wait is false
+    std::uint8_t* acquire(bool wait = false);
+    // Publishes the slot acquire() returned
+    void submit();
+    void drop();
+
+    // Writes out every queued frame and closes the file; false if a write failed
+    bool close();
+
+    VideoStats getStats() const;
+    VideoFormat getFormat() const { return format; }
+};
@@ -0,0 +1,339 @@
+// Monte Carlo balance simulator: plays many full games per rule set and bot
+// policy on a work-stealing thread pool and reports how they end. --solve
+// adds the exact best-play survival odds of every rule set; with --games 0
+// that is all it computes.
+//
+//   balance_sim --games 5000 --policy balanced,greedy
+//               --set spawnInterval=1.5,2,2.5 --set goldenDesire=-10,-15 --csv out.csv
+//   balance_sim --games 0 --solve --set rottenDesire=20,30,40
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../src/bot_policy.hpp"
+#include "../src/simulation.hpp"
+#include "../src/survival_solver.hpp"
+#include "../src/thread_pool.hpp"
+
+namespace {
+
+struct RuleAxis {
+    std::string name;
+    std::vector<float> values;
+};
+
+struct ParameterSet {
+    std::string label;
+    BalanceRules rules;
+};
+
+struct GameResult {
+    int score;
+    SimStatus status;
+    GameOverCause cause;
+    float duration;
+};
+
+struct CellSummary {
+    std::string parameters;
+    std::string policy;
+    int games = 0;
+    int victories = 0;
+    int apathy = 0;
+    int obsession = 0;
+    int timesUp = 0;
+    double meanScore = 0;
+    double stddevScore = 0;
+    int p10 = 0;
+    int p50 = 0;
+    int p90 = 0;
+    int maxScore = 0;
+    double meanDuration = 0;
+};
+
+struct ExactSummary {
+    std::string parameters;
+    bool solved;
+    SurvivalOdds odds;
+    std::size_t states;
+    double milliseconds;
+};
+
+void printUsage() {
+    std::printf("usage: balance_sim [--games N] [--threads T] [--seed S] [--policy a,b,...]\n"
+                "                   [--set rule=v1,v2,...]... [--solve] [--csv file]\n\n"
+                "policies:");
+    for (const auto& name : botPolicyNames()) {
+        std::printf(" %s", name.c_str());
+    }
+    std::printf("\nrules:");
+    for (const auto& name : balanceRuleNames()) {
+        std::printf(" %s", name.c_str());
+    }
+    std::printf("\n");
+}
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Cartesian product of all --set axes
+std::vector<ParameterSet> expandGrid(const std::vector<RuleAxis>& axes) {
+    std::vector<ParameterSet> sets(1);
+    sets[0].label = "default";
+
+    for (const auto& axis : axes) {
+        std::vector<ParameterSet> expanded;
+        for (const auto& base : sets) {
+            for (float value : axis.values) {
+                ParameterSet set = base;
+                setBalanceRule(set.rules, axis.name, value);
+
+                char entry[96];
+                std::snprintf(entry, sizeof(entry), "%s=%g", axis.name.c_str(), value);
+                set.label = base.label == "default" ? entry : base.label + " " + entry;
+                expanded.push_back(set);
+            }
+        }
+        sets.swap(expanded);
+    }
+    return sets;
+}
+
+GameResult playGame(const BalanceRules& rules, BotPolicy& policy, std::uint64_t seed) {
+    Simulation sim(rules, seed);
+    policy.reset(seed);
+
+    while (sim.getStatus() == SimStatus::RUNNING) {
+        sim.step(policy.decide(sim), SIM_TICK);
+    }
+    return GameResult{sim.getScore(), sim.getStatus(), sim.getCause(), sim.getGameTime()};
+}
+
+CellSummary summarize(const GameResult* results, int count) {
+    CellSummary summary;
+    summary.games = count;
+
+    std::vector<int> scores;
+    scores.reserve(count);
+    double total = 0;
+    double duration = 0;
+    for (int i = 0; i < count; ++i) {
+        const GameResult& result = results[i];
+        scores.push_back(result.score);
+        total += result.score;
+        duration += result.duration;
+
+        if (result.status == SimStatus::VICTORY) {
+            summary.victories++;
+        }
+        switch(result.cause) {
+            case GameOverCause::APATHY: summary.apathy++; break;
+            case GameOverCause::OBSESSION: summary.obsession++; break;
+            case GameOverCause::TIMES_UP: summary.timesUp++; break;
+            case GameOverCause::NONE: break;
+        }
+    }
+    if (count == 0) {
+        return summary;
+    }
+
+    summary.meanScore = total / count;
+    summary.meanDuration = duration / count;
+    double variance = 0;
+    for (int score : scores) {
+        variance += (score - summary.meanScore) * (score - summary.meanScore);
+    }
+    summary.stddevScore = std::sqrt(variance / count);
+
+    std::sort(scores.begin(), scores.end());
+    auto percentile = [&](double p) {
+        return scores[std::min(scores.size() - 1, static_cast<size_t>(p * (scores.size() - 1) + 0.5))];
+    };
+    summary.p10 = percentile(0.10);
+    summary.p50 = percentile(0.50);
+    summary.p90 = percentile(0.90);
+    summary.maxScore = scores.back();
+    return summary;
+}
+
+double percent(int part, int whole) {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int games = 1000;
+    unsigned threads = 0;
+    std::uint64_t baseSeed = 1;
+    std::vector<std::string> policies = {"balanced"};
+    std::vector<RuleAxis> axes;
+    std::string csvPath;
+    bool solve = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--games" && hasValue) {
+            games = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            baseSeed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--policy" && hasValue) {
+            policies = splitList(argv[++i]);
+        } else if (arg == "--solve") {
+            solve = true;
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else if (arg == "--set" && hasValue) {
+            std::string spec = argv[++i];
+            size_t equals = spec.find('=');
+            RuleAxis axis;
+            axis.name = spec.substr(0, equals);
+            if (equals != std::string::npos) {
+                for (const auto& value : splitList(spec.substr(equals + 1))) {
+                    axis.values.push_back(std::strtof(value.c_str(), nullptr));
+                }
+            }
+            BalanceRules probe;
+            if (axis.values.empty() || !setBalanceRule(probe, axis.name, 0.f)) {
+                std::fprintf(stderr, "bad --set '%s'\n", spec.c_str());
+                printUsage();
+                return 1;
+            }
+            axes.push_back(axis);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    for (const auto& name : policies) {
+        if (!makeBotPolicy(name)) {
+            std::fprintf(stderr, "unknown policy '%s'\n", name.c_str());
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::vector<ParameterSet> sets = expandGrid(axes);
+    const size_t cells = games > 0 ? sets.size() * policies.size() : 0;
+    const size_t totalGames = cells * static_cast<size_t>(games);
+    std::vector<GameResult> results(totalGames);
+
+    ThreadPool pool(threads);
+    std::vector<CellSummary> summaries;
+    if (totalGames > 0) {
+        std::printf("Running %zu games (%zu parameter sets x %zu policies x %d) on %u threads\n",
+                    totalGames, sets.size(), policies.size(), games, pool.size());
+
+        auto start = std::chrono::steady_clock::now();
+        pool.parallelFor(totalGames, 16, [&](size_t begin, size_t end) {
+            std::unique_ptr<BotPolicy> policy;
+            size_t policyIndex = policies.size();
+            for (size_t i = begin; i < end; ++i) {
+                size_t cell = i / games;
+                size_t cellPolicy = cell % policies.size();
+                if (cellPolicy != policyIndex) {
+                    policy = makeBotPolicy(policies[cellPolicy]);
+                    policyIndex = cellPolicy;
+                }
+                const BalanceRules& rules = sets[cell / policies.size()].rules;
+                std::uint64_t seed = baseSeed + i % games;
+                results[i] = playGame(rules, *policy, seed);
+            }
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        for (size_t cell = 0; cell < cells; ++cell) {
+            CellSummary summary = summarize(&results[cell * games], games);
+            summary.parameters = sets[cell / policies.size()].label;
+            summary.policy = policies[cell % policies.size()];
+            summaries.push_back(summary);
+        }
+
+        std::printf("\n%-32s %-9s %8s %8s %8s %8s %9s %8s %6s %6s %6s %6s\n",
+                    "parameters", "policy", "survive%", "apathy%", "obsess%", "timeup%",
+                    "meanScore", "stddev", "p10", "p50", "p90", "max");
+        for (const auto& s : summaries) {
+            std::printf("%-32s %-9s %8.1f %8.1f %8.1f %8.1f %9.1f %8.1f %6d %6d %6d %6d\n",
+                        s.parameters.c_str(), s.policy.c_str(),
+                        percent(s.victories, s.games), percent(s.apathy, s.games),
+                        percent(s.obsession, s.games), percent(s.timesUp, s.games),
+                        s.meanScore, s.stddevScore, s.p10, s.p50, s.p90, s.maxScore);
+        }
+        std::printf("\n%.2fs wall, %.0f games/s, %zu steals\n",
+                    seconds, totalGames / seconds, pool.stealCount());
+    }
+
+    // One solver reuses its tables from rule set to rule set
+    std::vector<ExactSummary> exact;
+    if (solve) {
+        SurvivalSolver solver;
+        for (const auto& set : sets) {
+            auto start = std::chrono::steady_clock::now();
+            ExactSummary summary;
+            summary.parameters = set.label;
+            summary.solved = solver.solve(set.rules, &pool);
+            summary.odds = solver.start();
+            summary.states = solver.getStateCount();
+            summary.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            exact.push_back(summary);
+        }
+
+        std::printf("\nExact best play, every apple caught or dodged at will:\n");
+        std::printf("%-32s %8s %9s %10s %9s\n", "parameters", "survive%", "meanScore", "states", "ms");
+        for (const auto& e : exact) {
+            if (!e.solved) {
+                std::printf("%-32s %s\n", e.parameters.c_str(), "unsupported rules (negative score or decay)");
+                continue;
+            }
+            std::printf("%-32s %8.2f %9.1f %10zu %9.1f\n", e.parameters.c_str(),
+                        e.odds.survival * 100.0, e.odds.expectedScore, e.states, e.milliseconds);
+        }
+    }
+
+    if (!csvPath.empty()) {
+        FILE* csv = std::fopen(csvPath.c_str(), "w");
+        if (!csv) {
+            std::fprintf(stderr, "cannot write %s\n", csvPath.c_str());
+            return 1;
+        }
+        std::fprintf(csv, "parameters,policy,games,survival,apathy,obsession,times_up,"
+                          "mean_score,stddev_score,p10,p50,p90,max_score,mean_duration\n");
+        for (const auto& s : summaries) {
+            std::fprintf(csv, "\"%s\",%s,%d,%.4f,%.4f,%.4f,%.4f,%.2f,%.2f,%d,%d,%d,%d,%.2f\n",
+                         s.parameters.c_str(), s.policy.c_str(), s.games,
+                         percent(s.victories, s.games) / 100.0, percent(s.apathy, s.games) / 100.0,
+                         percent(s.obsession, s.games) / 100.0, percent(s.timesUp, s.games) / 100.0,
+                         s.meanScore, s.stddevScore, s.p10, s.p50, s.p90, s.maxScore, s.meanDuration);
+        }
+        // Exact rows have no games, so only survival and mean score are filled in
+        for (const auto& e : exact) {
+            if (e.solved) {
+                std::fprintf(csv, "\"%s\",exact,0,%.6f,,,,%.2f,,,,,,\n",
+                             e.parameters.c_str(), e.odds.survival, e.odds.expectedScore);
+            }
+        }
+        std::fclose(csv);
+    }
+    return 0;
+}
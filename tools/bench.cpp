@@ -0,0 +1,697 @@
+// Microbenchmarks for the simulation and rendering hot paths. Each case is
+// calibrated to run for at least --min-time per sample and reports the median
+// and fastest of --repeats samples.
+//
+//   bench --json bench.json --csv bench.csv --filter apple_update
+//   bench --replay replays/seed-42.replay --filter replay
+//
+// Built without SFML (make bench_sim) the render cases are left out.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/apple_field.hpp"
+#include "../src/apple_grid.hpp"
+#include "../src/intro_scene.hpp"
+#include "../src/lookahead_planner.hpp"
+#include "../src/mapped_file.hpp"
+#include "../src/particle_field.hpp"
+#include "../src/replay.hpp"
+#include "../src/simulation.hpp"
+#include "../src/survival_solver.hpp"
+#include "../src/thread_pool.hpp"
+#include "../src/timer_wheel.hpp"
+#include "../src/vector_env.hpp"
+#include "../src/video_encoder.hpp"
+
+#if !defined(APPLE_BENCH_NO_RENDER)
+#include <SFML/Graphics.hpp>
+#include "../frontend/apple_batch.hpp"
+#include "../frontend/particle_batch.hpp"
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const std::size_t FIELD_SIZES[] = {10, 100, 1000, 10000, 100000};
+
+const std::size_t COLLIDER_COUNTS[] = {1, 2, 4, 8, 16, 32, 64};
+const std::size_t COLLIDER_FIELD_SIZE = 10000;
+
+const std::size_t TIMER_COUNTS[] = {10, 1000, 100000};
+
+const int PLAYER_COUNTS[] = {1, 2, 4, 8};
+
+const std::size_t ENV_COUNTS[] = {1, 64, 1024, 8192};
+
+// Per-apple CircleShape draws, the renderer before batching, get slow enough
+// to dominate the run past this size
+const std::size_t SHAPE_RENDER_LIMIT = 10000;
+
+struct BenchOptions {
+    double minTimeMs = 50.0;
+    int repeats = 5;
+    std::size_t maxSize = 100000;
+    std::string filter;
+};
+
+struct BenchResult {
+    std::string name;
+    std::size_t n;
+    std::uint64_t iterations;
+    double medianNs;
+    double minNs;
+};
+
+// Keeps the optimizer from discarding the benchmarked work
+volatile std::size_t sink;
+
+// Times fn(), one operation, and returns the median and fastest nanoseconds
+// per operation. after(), if given, runs once per sample inside the timed
+// region, e.g. to wait for the GPU.
+template <typename Fn, typename After>
+BenchResult measure(const BenchOptions& options, const std::string& name, std::size_t n,
+                    Fn&& fn, After&& after) {
+    auto runSample = [&](std::uint64_t iterations) {
+        auto start = Clock::now();
+        for (std::uint64_t i = 0; i < iterations; ++i) {
+            fn();
+        }
+        after();
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    std::uint64_t iterations = 1;
+    double elapsed = runSample(iterations);
+    while (elapsed < options.minTimeMs * 1e6 && iterations < (1ull << 40)) {
+        double scale = elapsed > 0 ? options.minTimeMs * 1e6 / elapsed * 1.2 : 10.0;
+        iterations = static_cast<std::uint64_t>(iterations * std::min(10.0, std::max(2.0, scale)));
+        elapsed = runSample(iterations);
+    }
+
+    std::vector<double> samples;
+    for (int r = 0; r < options.repeats; ++r) {
+        samples.push_back(runSample(iterations) / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+    return BenchResult{name, n, iterations, samples[samples.size() / 2], samples.front()};
+}
+
+template <typename Fn>
+BenchResult measure(const BenchOptions& options, const std::string& name, std::size_t n, Fn&& fn) {
+    return measure(options, name, n, fn, [] {});
+}
+
+// N apples scattered over the playfield
+AppleField makeField(std::size_t n, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> column(0.f, WIDTH - APPLE_RADIUS * 2.f);
+    std::uniform_real_distribution<float> row(0.f, HEIGHT - APPLE_RADIUS * 2.f);
+    std::uniform_real_distribution<float> fall(1.f, 3.f);
+    std::uniform_int_distribution<int> kind(0, 2);
+
+    AppleField apples(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        apples.spawn(column(rng), row(rng), fall(rng), static_cast<AppleType>(kind(rng)));
+    }
+    return apples;
+}
+
+// Sparks sprayed from the middle of the playfield with in-game lifetimes
+const ParticleBurst BENCH_SPRAY = {0, -1.5707964f, 3.1415927f, 0.5f, 4.f, 0.3f, 1.5f, 1.f, 3.f, 0.1f, 0xFFD700FF};
+
+// Sprays particles until there are n of them
+void topUpParticles(ParticleField& particles, CounterRng& rng, std::size_t n) {
+    ParticleBurst spray = BENCH_SPRAY;
+    spray.count = static_cast<int>(n - particles.size());
+    emitBurst(particles, rng, spray, WIDTH / 2.f, HEIGHT / 2.f);
+}
+
+Box centerBasket() {
+    Basket basket;
+    basket.x = WIDTH / 2.f;
+    basket.previousX = basket.x;
+    return basket.getBounds();
+}
+
+class BenchRunner {
+private:
+    BenchOptions options;
+    std::vector<BenchResult> results;
+
+    bool selected(const std::string& name) const {
+        return options.filter.empty() || name.find(options.filter) != std::string::npos;
+    }
+
+    void report(const BenchResult& result) {
+        std::printf("%-22s %8zu %12llu %14.1f %14.1f %12.2f\n",
+                    result.name.c_str(), result.n, static_cast<unsigned long long>(result.iterations),
+                    result.medianNs, result.minNs, result.medianNs / std::max<std::size_t>(1, result.n));
+        std::fflush(stdout);
+        results.push_back(result);
+    }
+
+public:
+    explicit BenchRunner(const BenchOptions& benchOptions) : options(benchOptions) {}
+
+    const std::vector<BenchResult>& getResults() const { return results; }
+
+    void appleUpdate() {
+        for (std::size_t n : FIELD_SIZES) {
+            if (n > options.maxSize) {
+                continue;
+            }
+            // Alternating the step direction keeps every apple on screen and
+            // away from the basket, so this is the pure move + test cost
+            AppleField apples = makeField(n, 1);
+            std::vector<std::uint32_t> resolved;
+            resolved.reserve(n);
+            float direction = 1.f;
+
+            if (selected("apple_update")) {
+                report(measure(options, "apple_update", n, [&] {
+                    resolved.clear();
+                    advanceApples(apples, NO_BASKET, direction, resolved);
+                    direction = -direction;
+                    sink = resolved.size();
+                }));
+            }
+            if (selected("apple_update_scalar")) {
+                report(measure(options, "apple_update_scalar", n, [&] {
+                    resolved.clear();
+                    advanceApplesScalar(apples, 0, NO_BASKET, direction, resolved);
+                    direction = -direction;
+                    sink = resolved.size();
+                }));
+            }
+        }
+    }
+
+    void basketCollision() {
+        if (!selected("basket_collision")) {
+            return;
+        }
+        const Box basket = centerBasket();
+        for (std::size_t n : FIELD_SIZES) {
+            if (n > options.maxSize) {
+                continue;
+            }
+            // Packed into the band around the basket so a real share of the
+            // apples hit and go through the resolve path
+            AppleField apples(n);
+            std::mt19937 rng(2);
+            std::uniform_real_distribution<float> column(basket.left - 100.f, basket.left + basket.width + 100.f);
+            std::uniform_real_distribution<float> row(basket.top - 40.f, basket.top + basket.height + 10.f);
+            for (std::size_t i = 0; i < n; ++i) {
+                apples.spawn(column(rng), row(rng), 2.f, AppleType::RED);
+            }
+            std::vector<std::uint32_t> resolved;
+            resolved.reserve(n);
+
+            report(measure(options, "basket_collision", n, [&] {
+                resolved.clear();
+                advanceApples(apples, basket, 0.f, resolved);
+                sink = resolved.size();
+            }));
+        }
+    }
+
+    void colliders() {
+        // Baskets along the basket row, as players share it, against 10k
+        // apples: the broadphase visits only the row's cells and, within a
+        // cell, only the baskets level with and reaching each apple; the
+        // reference tests every apple against every basket. n is the basket
+        // count; with many baskets they overlap and the hits themselves grow
+        // with n.
+        AppleField apples = makeField(std::min(COLLIDER_FIELD_SIZE, options.maxSize), 6);
+        AppleGrid grid(apples.capacity());
+        grid.update(apples);
+        std::vector<AppleHit> hits;
+        hits.reserve(apples.size() * 8);
+
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> column(35.f, WIDTH - 35.f);
+        std::vector<Box> boxes;
+        for (std::size_t count : COLLIDER_COUNTS) {
+            while (boxes.size() < count) {
+                Basket basket;
+                basket.x = column(rng);
+                boxes.push_back(basket.getBounds());
+            }
+            if (selected("collide_grid")) {
+                report(measure(options, "collide_grid", count, [&] {
+                    hits.clear();
+                    grid.collide(apples, boxes.data(), boxes.size(), hits);
+                    sink = hits.size();
+                }));
+            }
+            if (selected("collide_brute")) {
+                report(measure(options, "collide_brute", count, [&] {
+                    hits.clear();
+                    for (std::size_t i = 0; i < apples.size(); ++i) {
+                        Box bounds{apples.x[i], apples.y[i], APPLE_RADIUS * 2.f, APPLE_RADIUS * 2.f};
+                        for (std::size_t c = 0; c < boxes.size(); ++c) {
+                            if (bounds.intersects(boxes[c])) {
+                                hits.push_back(AppleHit{static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(c)});
+                            }
+                        }
+                    }
+                    sink = hits.size();
+                }));
+            }
+        }
+
+        if (selected("grid_update")) {
+            // Incremental relink as the whole field drifts by one tick
+            float direction = 1.f;
+            std::vector<std::uint32_t> resolved;
+            resolved.reserve(apples.size());
+            report(measure(options, "grid_update", apples.size(), [&] {
+                resolved.clear();
+                advanceApples(apples, NO_BASKET, direction, resolved);
+                direction = -direction;
+                grid.update(apples);
+            }));
+        }
+    }
+
+    void timerWheel() {
+        if (!selected("timer_wheel")) {
+            return;
+        }
+        // One tick with n periodic timers pending, periods spread over
+        // 1 to 1000 ticks, so some fire and cascade every tick
+        for (std::size_t count : TIMER_COUNTS) {
+            TimerWheel wheel;
+            for (std::size_t i = 0; i < count; ++i) {
+                wheel.schedule(1 + i % 1000, 0, 1 + (i * 7919) % 1000);
+            }
+            std::size_t fired = 0;
+            report(measure(options, "timer_wheel", count, [&] {
+                wheel.advanceTo(wheel.getNow() + 1, [&](std::uint32_t) { fired++; });
+                sink = fired;
+            }));
+        }
+    }
+
+    void spawnApple() {
+        if (!selected("spawn_apple")) {
+            return;
+        }
+        // Refills the pool from empty; the reset every APPLE_POOL_CAPACITY
+        // spawns is part of the amortized cost
+        Simulation sim(BalanceRules(), 3);
+        report(measure(options, "spawn_apple", 1, [&] {
+            if (!sim.spawnApple()) {
+                sim.reset();
+            }
+        }));
+    }
+
+    void simStep() {
+        if (!selected("sim_step")) {
+            return;
+        }
+        Simulation sim(BalanceRules(), 4);
+        SimInput input;
+        unsigned steps = 0;
+        report(measure(options, "sim_step", 1, [&] {
+            // Sweep the basket back and forth so apples are both caught and missed
+            input.left = (++steps / 120) % 2 == 0;
+            input.right = !input.left;
+            sim.step(input, SIM_TICK);
+            if (sim.getStatus() != SimStatus::RUNNING) {
+                sim.reset();
+            }
+        }));
+    }
+
+    void simStepPlayers() {
+        if (!selected("sim_step_players")) {
+            return;
+        }
+        // A storm of a few hundred live apples, with nobody ever knocked out,
+        // so the per-tick cost of adding baskets shows
+        BalanceRules rules;
+        rules.spawnInterval = 0.01f;
+        rules.minDesire = 0;
+        rules.maxDesire = 100;
+        rules.minSafeCap = 0;
+        rules.maxSafeFloor = 100;
+        rules.rangeStep = 0;
+        rules.duration = 1e9f;
+        for (int players : PLAYER_COUNTS) {
+            Simulation sim(rules, 5, players);
+            SimInput inputs[MAX_PLAYERS];
+            unsigned steps = 0;
+            report(measure(options, "sim_step_players", static_cast<std::size_t>(players), [&] {
+                steps++;
+                for (int p = 0; p < players; ++p) {
+                    inputs[p].left = ((steps + p * 37) / 120) % 2 == 0;
+                    inputs[p].right = !inputs[p].left;
+                }
+                sim.step(inputs, SIM_TICK);
+                if (sim.getStatus() != SimStatus::RUNNING) {
+                    sim.reset();
+                }
+            }));
+        }
+    }
+
+    // A from-scratch autopilot search over a dense field (the worst case a
+    // frame can meet) at the bot's node budget, and a tick of steering
+    void planner() {
+        BalanceRules rules;
+        rules.spawnInterval = 0.2f;
+        rules.speedMultiplier = 1.f;
+        rules.minDesire = 0;
+        rules.maxDesire = 100;
+        Simulation sim(rules, 9);
+        LookaheadPlanner autopilot;
+        for (int tick = 0; tick < 10 * SIM_TICK_RATE; ++tick) {
+            sim.step(autopilot.decide(sim), SIM_TICK);
+        }
+        const std::size_t inView = static_cast<std::size_t>(autopilot.getStats().apples);
+
+        if (selected("planner_search")) {
+            report(measure(options, "planner_search", inView, [&] {
+                autopilot.invalidate();
+                autopilot.plan(sim, PLANNER_DEFAULT_NODES);
+                sink = autopilot.getStats().nodes;
+            }));
+        }
+        if (selected("planner_steer")) {
+            report(measure(options, "planner_steer", inView, [&] {
+                sink = autopilot.steer(sim).left;
+            }));
+        }
+    }
+
+    // A full best-play table for the default rules; ns/item is per state
+    void survivalSolve() {
+        ThreadPool pool;
+        for (bool pooled : {false, true}) {
+            const char* name = pooled ? "survival_solve_pooled" : "survival_solve";
+            if (!selected(name)) {
+                continue;
+            }
+            SurvivalSolver solver;
+            solver.solve(BalanceRules());
+            report(measure(options, name, solver.getStateCount(), [&] {
+                solver.solve(BalanceRules(), pooled ? &pool : nullptr);
+                sink = static_cast<std::size_t>(solver.start().expectedScore);
+            }));
+        }
+    }
+
+    // Colour conversion of one recorded frame, the encoder's per-frame work
+    // besides the write; ns/item is per pixel
+    void videoConvert() {
+        if (!selected("video_rgba_to_i420")) {
+            return;
+        }
+        const std::size_t pixels = static_cast<std::size_t>(WIDTH) * HEIGHT;
+        std::vector<std::uint8_t> rgba(pixels * 4);
+        std::mt19937 rng(4);
+        for (auto& channel : rgba) {
+            channel = static_cast<std::uint8_t>(rng());
+        }
+        std::vector<std::uint8_t> yuv(pixels * 3 / 2);
+        report(measure(options, "video_rgba_to_i420", pixels, [&] {
+            rgbaToI420(rgba.data(), WIDTH, HEIGHT, yuv.data());
+            sink = yuv[0];
+        }));
+    }
+
+    // One step of K environments with the basket sweeping like sim_step;
+    // ns/item is per environment step
+    void vectorEnvStep() {
+        ThreadPool pool;
+        for (std::size_t k : ENV_COUNTS) {
+            if (k > options.maxSize) {
+                continue;
+            }
+            for (bool pooled : {false, true}) {
+                const char* name = pooled ? "vector_env_step_pooled" : "vector_env_step";
+                if (!selected(name)) {
+                    continue;
+                }
+                VectorEnv env(k, BalanceRules(), ENV_DEFAULT_APPLE_SLOTS, 1, pooled ? &pool : nullptr);
+                std::vector<float> observations(k * env.getObservationSize());
+                std::vector<float> rewards(k);
+                std::vector<std::uint8_t> dones(k);
+                std::vector<std::uint8_t> actions(k);
+                env.reset(8, observations.data());
+                unsigned steps = 0;
+                report(measure(options, name, k, [&] {
+                    std::uint8_t action = (++steps / 120) % 2 == 0 ? ENV_ACTION_LEFT : ENV_ACTION_RIGHT;
+                    std::fill(actions.begin(), actions.end(), action);
+                    env.step(actions.data(), observations.data(), rewards.data(), dones.data());
+                    sink = dones[0];
+                }));
+            }
+        }
+    }
+
+    void introUpdate() {
+        if (!selected("intro_update")) {
+            return;
+        }
+        // The shipped script, run through to the held scene and over again,
+        // storm included
+        IntroScene intro;
+        MappedFile script;
+        std::string error;
+        if (!script.open("intro.script", error) ||
+            !intro.load(std::string(reinterpret_cast<const char*>(script.getData()), script.getSize()), error)) {
+            std::fprintf(stderr, "intro_update skipped: %s\n", error.c_str());
+            return;
+        }
+        report(measure(options, "intro_update", 1, [&] {
+            intro.update(SIM_TICK);
+            if (intro.isHolding()) {
+                intro.reset();
+            }
+            sink = intro.getApples().size();
+        }));
+    }
+
+    // One SIM_TICK of a field held at n particles, topped up after every
+    // update as a steady stream of bursts would, on this thread and split
+    // across a pool of every hardware thread
+    void particleUpdate() {
+        ThreadPool pool;
+        for (std::size_t n : FIELD_SIZES) {
+            if (n > options.maxSize) {
+                continue;
+            }
+            ParticleField particles(n);
+            CounterRng rng(6);
+            topUpParticles(particles, rng, n);
+            if (selected("particle_update")) {
+                report(measure(options, "particle_update", n, [&] {
+                    particles.update(SIM_TICK);
+                    topUpParticles(particles, rng, n);
+                    sink = particles.size();
+                }));
+            }
+            if (selected("particle_update_pooled")) {
+                report(measure(options, "particle_update_pooled", n, [&] {
+                    particles.update(SIM_TICK, &pool);
+                    topUpParticles(particles, rng, n);
+                    sink = particles.size();
+                }));
+            }
+        }
+    }
+
+    // A recorded game re-simulated from its log: real player input, timed per tick
+    void replay(const ReplayLog& log) {
+        if (!selected("replay")) {
+            return;
+        }
+        std::uint64_t ticks = simulateReplay(log).ticks;
+        BenchResult result = measure(options, "replay", static_cast<std::size_t>(ticks), [&] {
+            sink = static_cast<std::size_t>(simulateReplay(log).score);
+        });
+        report(result);
+    }
+
+#if !defined(APPLE_BENCH_NO_RENDER)
+    void render() {
+        sf::RenderTexture texture;
+        if (!texture.resize(sf::Vector2u(WIDTH, HEIGHT))) {
+            std::fprintf(stderr, "render: no offscreen render texture, skipping\n");
+            return;
+        }
+        // Reading a pixel back drains the GPU queue, so each sample includes
+        // the frames' actual rendering and not just their submission
+        auto finish = [&] { sink = texture.getTexture().copyToImage().getSize().x; };
+
+        AppleBatch batch;
+        for (std::size_t n : FIELD_SIZES) {
+            if (n > options.maxSize) {
+                continue;
+            }
+            AppleField apples = makeField(n, 5);
+
+            if (selected("render_batch")) {
+                report(measure(options, "render_batch", n, [&] {
+                    texture.clear(sf::Color::Black);
+                    batch.clear();
+                    batch.addApples(apples);
+                    batch.draw(texture);
+                    texture.display();
+                }, finish));
+            }
+            if (selected("render_particles")) {
+                ParticleField particles(n);
+                CounterRng rng(7);
+                topUpParticles(particles, rng, n);
+                ParticleBatch particleBatch;
+                report(measure(options, "render_particles", n, [&] {
+                    texture.clear(sf::Color::Black);
+                    particleBatch.clear();
+                    particleBatch.addParticles(particles);
+                    particleBatch.draw(texture);
+                    texture.display();
+                }, finish));
+            }
+            if (selected("render_shapes") && n <= SHAPE_RENDER_LIMIT) {
+                sf::CircleShape circle(APPLE_RADIUS);
+                report(measure(options, "render_shapes", n, [&] {
+                    texture.clear(sf::Color::Black);
+                    for (std::size_t i = 0; i < apples.size(); ++i) {
+                        circle.setPosition(sf::Vector2f(apples.x[i], apples.y[i]));
+                        circle.setFillColor(appleColor(apples.type[i]));
+                        texture.draw(circle);
+                    }
+                    texture.display();
+                }, finish));
+            }
+        }
+    }
+#endif
+};
+
+bool writeJson(const std::string& path, const std::vector<BenchResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "{\n  \"benchmarks\": [\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        std::fprintf(file, "    {\"name\": \"%s\", \"n\": %zu, \"iterations\": %llu, "
+                           "\"median_ns\": %.2f, \"min_ns\": %.2f, \"ns_per_item\": %.3f}%s\n",
+                     r.name.c_str(), r.n, static_cast<unsigned long long>(r.iterations),
+                     r.medianNs, r.minNs, r.medianNs / std::max<std::size_t>(1, r.n),
+                     i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
+
+bool writeCsv(const std::string& path, const std::vector<BenchResult>& results) {
+    FILE* file = std::fopen(path.c_str(), "w");
+    if (!file) {
+        return false;
+    }
+    std::fprintf(file, "name,n,iterations,median_ns,min_ns,ns_per_item\n");
+    for (const auto& r : results) {
+        std::fprintf(file, "%s,%zu,%llu,%.2f,%.2f,%.3f\n",
+                     r.name.c_str(), r.n, static_cast<unsigned long long>(r.iterations),
+                     r.medianNs, r.minNs, r.medianNs / std::max<std::size_t>(1, r.n));
+    }
+    std::fclose(file);
+    return true;
+}
+
+void printUsage() {
+    std::printf("usage: bench [--filter text] [--min-time ms] [--repeats R] [--max-n N]\n"
+                "             [--replay file] [--json file] [--csv file]\n");
+}
+
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options;
+    std::string jsonPath;
+    std::string csvPath;
+    std::string replayPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTimeMs = std::max(1.0, std::atof(argv[++i]));
+        } else if (arg == "--repeats" && hasValue) {
+            options.repeats = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--max-n" && hasValue) {
+            options.maxSize = static_cast<std::size_t>(std::strtoull(argv[++i], nullptr, 10));
+        } else if (arg == "--replay" && hasValue) {
+            replayPath = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    ReplayLog log;
+    if (!replayPath.empty()) {
+        std::string error;
+        if (!log.open(replayPath, error)) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("%-22s %8s %12s %14s %14s %12s\n",
+                "benchmark", "n", "iterations", "median ns/op", "min ns/op", "ns/item");
+
+    BenchRunner runner(options);
+    runner.appleUpdate();
+    runner.basketCollision();
+    runner.colliders();
+    runner.timerWheel();
+    runner.spawnApple();
+    runner.simStep();
+    runner.simStepPlayers();
+    runner.vectorEnvStep();
+    runner.planner();
+    runner.survivalSolve();
+    runner.videoConvert();
+    runner.introUpdate();
+    runner.particleUpdate();
+    if (!replayPath.empty()) {
+        runner.replay(log);
+    }
+#if !defined(APPLE_BENCH_NO_RENDER)
+    runner.render();
+#endif
+
+    if (!jsonPath.empty() && !writeJson(jsonPath, runner.getResults())) {
+        std::fprintf(stderr, "cannot write %s\n", jsonPath.c_str());
+        return 1;
+    }
+    if (!csvPath.empty() && !writeCsv(csvPath, runner.getResults())) {
+        std::fprintf(stderr, "cannot write %s\n", csvPath.c_str());
+        return 1;
+    }
+    return 0;
+}
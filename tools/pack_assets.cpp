@@ -0,0 +1,51 @@
+// Packs the game's font, music, sounds and images into one archive that the
+// game maps at startup instead of probing for each file.
+//
+//   pack_assets [--out assets.pak]
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "../src/asset_pack.hpp"
+
+int main(int argc, char** argv) {
+    std::string outPath = "assets.pak";
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) {
+            outPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "usage: pack_assets [--out assets.pak]\n");
+            return 1;
+        }
+    }
+
+    std::vector<AssetSource> sources = resolveGameAssets();
+    for (const AssetCandidates& asset : gameAssetCandidates()) {
+        bool found = false;
+        for (const AssetSource& source : sources) {
+            found = found || source.name == asset.name;
+        }
+        if (!found) {
+            std::fprintf(stderr, "warning: no file for '%s', the game will go without it\n", asset.name);
+        }
+    }
+
+    std::string error;
+    if (!writeAssetPack(outPath, sources, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+
+    AssetPack pack;
+    if (!pack.open(outPath, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    for (const AssetEntry& entry : pack.getEntries()) {
+        std::printf("%-16s %10zu bytes\n", entry.name.c_str(), entry.size);
+    }
+    std::printf("wrote %s\n", outPath.c_str());
+    return 0;
+}